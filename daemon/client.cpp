@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: MIT
+
+#include "client.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace rpmcmplib::rpmcmpd {
+
+namespace {
+
+void readAll(int fd, uint8_t* data, size_t size) {
+    size_t received = 0;
+    while (received < size) {
+        ssize_t result = ::recv(fd, data + received, size - received, 0);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            throw std::system_error(result == 0 ? ECONNRESET : errno, std::generic_category(), "recv");
+        }
+        received += static_cast<size_t>(result);
+    }
+}
+
+void writeAll(int fd, const std::vector<uint8_t>& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t result = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0) {
+            throw std::system_error(errno, std::generic_category(), "send");
+        }
+        sent += static_cast<size_t>(result);
+    }
+}
+
+} // namespace
+
+Client::Client(const std::string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid socket path " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    m_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "socket");
+    }
+
+    if (::connect(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        int error = errno;
+        ::close(m_fd);
+        throw std::system_error(error, std::generic_category(), "connect " + socketPath);
+    }
+}
+
+Client::~Client() {
+    ::close(m_fd);
+}
+
+int Client::compare(std::string_view lhs, std::string_view rhs) {
+    auto writer = request(Opcode::Compare);
+    writer.str(lhs).str(rhs);
+    auto response = call(writer);
+    return static_cast<int8_t>(Reader(response.data(), response.size()).u8());
+}
+
+std::vector<uint32_t> Client::sort(const std::vector<std::string>& evrs) {
+    auto writer = request(Opcode::Sort);
+    writer.u32(static_cast<uint32_t>(evrs.size()));
+    for (const auto& evr : evrs) {
+        writer.str(evr);
+    }
+
+    auto response = call(writer);
+    Reader reader(response.data(), response.size());
+    std::vector<uint32_t> order(reader.u32());
+    for (auto& index : order) {
+        index = reader.u32();
+    }
+    return order;
+}
+
+std::string Client::newest(std::string_view name) {
+    auto writer = request(Opcode::Newest);
+    writer.str(name);
+    auto response = call(writer);
+    return std::string(Reader(response.data(), response.size()).str());
+}
+
+std::vector<std::string> Client::match(std::string_view name, Constraint constraint, std::string_view evr) {
+    auto writer = request(Opcode::Match);
+    writer.str(name).u8(static_cast<uint8_t>(constraint)).str(evr);
+
+    auto response = call(writer);
+    Reader reader(response.data(), response.size());
+    std::vector<std::string> matched(reader.u32());
+    for (auto& version : matched) {
+        version = reader.str();
+    }
+    return matched;
+}
+
+size_t Client::reload(const std::string& path) {
+    auto writer = request(Opcode::Reload);
+    writer.str(path);
+    auto response = call(writer);
+    return Reader(response.data(), response.size()).u32();
+}
+
+Writer Client::request(Opcode opcode) {
+    Writer writer;
+    writer.u32(m_nextId++).u8(static_cast<uint8_t>(opcode));
+    return writer;
+}
+
+std::vector<uint8_t> Client::call(Writer& request) {
+    writeAll(m_fd, request.finish());
+
+    uint8_t header[frameHeaderSize];
+    readAll(m_fd, header, sizeof(header));
+    std::vector<uint8_t> frame(frameLength(header));
+    readAll(m_fd, frame.data(), frame.size());
+
+    Reader reader(frame.data(), frame.size());
+    reader.u32(); // id, requests aren't pipelined
+    auto status = static_cast<Status>(reader.u8());
+    if (status != Status::Ok) {
+        throw RequestFailed(status, std::string(reader.str()));
+    }
+
+    // strip id and status, leave only body
+    frame.erase(frame.begin(), frame.begin() + 5);
+    return frame;
+}
+
+} // namespace rpmcmplib::rpmcmpd
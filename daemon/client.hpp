@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "protocol.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rpmcmplib::rpmcmpd {
+
+/**
+ * Server answered with non Ok status.
+ */
+class RequestFailed : public std::runtime_error {
+public:
+    RequestFailed(Status status, const std::string& what) : std::runtime_error(what), m_status(status) {}
+
+    Status status() const {
+        return m_status;
+    }
+
+private:
+    Status m_status;
+};
+
+/**
+ * Blocking client of rpmcmpd, one request at a time.
+ * All calls throw RequestFailed if server rejects the request
+ * and system_error if connection is broken.
+ */
+class Client {
+public:
+
+    /**
+     * @throw system_error if server can't be reached
+     */
+    explicit Client(const std::string& socketPath);
+    ~Client();
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    int compare(std::string_view lhs, std::string_view rhs);
+
+    /**
+     * @return Indices of evrs in ascending order.
+     */
+    std::vector<uint32_t> sort(const std::vector<std::string>& evrs);
+
+    std::string newest(std::string_view name);
+
+    /**
+     * @return EVRs of the package satisfying `version <constraint> evr` in ascending order.
+     */
+    std::vector<std::string> match(std::string_view name, Constraint constraint, std::string_view evr);
+
+    /**
+     * @param path - table file, empty path reloads current table source,
+     * other file is Forbidden unless daemon allows reload from path
+     * @return Number of records in the new table.
+     */
+    size_t reload(const std::string& path = "");
+
+private:
+    std::vector<uint8_t> call(Writer& request);
+    Writer request(Opcode opcode);
+
+    int m_fd = -1;
+    uint32_t m_nextId = 1;
+};
+
+} // namespace rpmcmplib::rpmcmpd
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: MIT
+
+#include "evr_table.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace rpmcmplib::rpmcmpd {
+
+std::shared_ptr<const EvrTable> EvrTable::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Can't open table file " + path);
+    }
+
+    std::ostringstream content;
+    content << file.rdbuf();
+    return parse(content.str(), path);
+}
+
+std::shared_ptr<const EvrTable> EvrTable::parse(std::string content, std::string source) {
+    return std::shared_ptr<const EvrTable>(new EvrTable(std::move(content), std::move(source)));
+}
+
+EvrTable::EvrTable(std::string content, std::string source)
+    : m_content(std::move(content)), m_source(std::move(source)) {
+    std::string_view rest = m_content;
+    size_t lineNumber = 0;
+    while (!rest.empty()) {
+        size_t lineEnd = std::min(rest.find('\n'), rest.size());
+        std::string_view line = rest.substr(0, lineEnd);
+        rest.remove_prefix(std::min(lineEnd + 1, rest.size()));
+        ++lineNumber;
+
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos || line[begin] == '#') {
+            continue;
+        }
+        line = line.substr(begin, line.find_last_not_of(" \t\r") - begin + 1);
+
+        size_t separator = line.find_first_of(" \t");
+        size_t evrStart = line.find_first_not_of(" \t", separator);
+        if (separator == std::string_view::npos || line.find_first_of(" \t", evrStart) != std::string_view::npos) {
+            throw std::invalid_argument("Line " + std::to_string(lineNumber) + ": expected `name evr`!");
+        }
+
+        std::string_view evr = line.substr(evrStart);
+        auto isValidCheckResult = RpmEvrView::isValid(evr);
+        if (!isValidCheckResult.empty()) {
+            throw std::invalid_argument("Line " + std::to_string(lineNumber) + ": " + isValidCheckResult);
+        }
+
+        auto& versions = m_versions[line.substr(0, separator)];
+        versions.evrs.emplace_back(evr);
+        versions.parts.push_back(detail::splitEvr(evr));
+        ++m_size;
+    }
+
+    // total order is strict even for labels rpmevrcmp isn't antisymmetric for (e.g. both have tilde)
+    for (auto& [name, versions] : m_versions) {
+        std::vector<size_t> order(versions.evrs.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&versions](size_t lhs, size_t rhs) {
+            return detail::orderEvrs<DefaultPolicy>(versions.parts[lhs], versions.parts[rhs]) < 0;
+        });
+
+        Versions sorted;
+        sorted.evrs.reserve(order.size());
+        sorted.parts.reserve(order.size());
+        for (size_t index : order) {
+            sorted.evrs.push_back(versions.evrs[index]);
+            sorted.parts.push_back(versions.parts[index]);
+        }
+        versions = std::move(sorted);
+    }
+}
+
+const std::string& EvrTable::source() const {
+    return m_source;
+}
+
+size_t EvrTable::size() const {
+    return m_size;
+}
+
+const std::vector<RpmEvrView>& EvrTable::versions(std::string_view name) const {
+    static const std::vector<RpmEvrView> empty;
+    auto it = m_versions.find(name);
+    return it == m_versions.end() ? empty : it->second.evrs;
+}
+
+const std::vector<EvrParts>& EvrTable::parts(std::string_view name) const {
+    static const std::vector<EvrParts> empty;
+    auto it = m_versions.find(name);
+    return it == m_versions.end() ? empty : it->second.parts;
+}
+
+const RpmEvrView* EvrTable::newest(std::string_view name) const {
+    const auto& nameVersions = versions(name);
+    return nameVersions.empty() ? nullptr : &nameVersions.back();
+}
+
+} // namespace rpmcmplib::rpmcmpd
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <rpmcmp.hpp>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rpmcmplib::rpmcmpd {
+
+/**
+ * Immutable in-memory table of package EVRs.
+ * 
+ * Table source is a text file with one `name [epoch:]version[-release]` pair
+ * per line, empty lines and lines starting with `#` are skipped.
+ * All EVRs are views into the loaded file content, they are validated, split
+ * and sorted per package name once at load time, so queries only search
+ * pre-split parts. Versions are sorted by detail::orderEvrs, which agrees with
+ * rpmevrcmp wherever it is antisymmetric.
+ */
+class EvrTable {
+public:
+    EvrTable(const EvrTable&) = delete;
+    EvrTable& operator=(const EvrTable&) = delete;
+
+    /**
+     * @throw runtime_error if file can't be read
+     * @throw invalid_argument if file contains invalid line
+     */
+    static std::shared_ptr<const EvrTable> load(const std::string& path);
+
+    /**
+     * @throw invalid_argument if content contains invalid line
+     */
+    static std::shared_ptr<const EvrTable> parse(std::string content, std::string source = "");
+
+    const std::string& source() const;
+    size_t size() const;
+
+    /**
+     * Get all EVRs of the package sorted from the oldest to the newest.
+     * Returned vector is empty if there is no such package.
+     */
+    const std::vector<RpmEvrView>& versions(std::string_view name) const;
+
+    /**
+     * Get parts of all EVRs of the package, in the same order as versions.
+     */
+    const std::vector<EvrParts>& parts(std::string_view name) const;
+
+    /**
+     * Get the newest EVR of the package.
+     * 
+     * @return Pointer to the EVR or nullptr if there is no such package.
+     */
+    const RpmEvrView* newest(std::string_view name) const;
+
+private:
+    EvrTable(std::string content, std::string source);
+
+    std::string m_content;
+    std::string m_source;
+    size_t m_size = 0;
+    struct Versions {
+        std::vector<RpmEvrView> evrs;
+        std::vector<EvrParts> parts;
+    };
+
+    std::unordered_map<std::string_view, Versions> m_versions;
+};
+
+} // namespace rpmcmplib::rpmcmpd
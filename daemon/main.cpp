@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: MIT
+
+#include "server.hpp"
+
+#include <charconv>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <pthread.h>
+
+namespace {
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " --socket PATH --table FILE [--workers N] [--batch N] [--allow-reload-path]\n"
+              << "\n"
+              << "Serve RPM EVR comparisons over Unix domain socket.\n"
+              << "Table file has one `name [epoch:]version[-release]` pair per line.\n"
+              << "SIGHUP or reload request reloads the table, SIGINT/SIGTERM stop the daemon.\n"
+              << "--allow-reload-path lets clients reload the table from another file.\n";
+}
+
+/**
+ * Parse positive decimal count of command line option.
+ * 
+ * @return Whether the whole value is a positive number.
+ */
+bool parseCount(const char* value, size_t& count) {
+    const char* end = value + std::strlen(value);
+    auto [ptr, ec] = std::from_chars(value, end, count);
+    return ec == std::errc() && ptr == end && count > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    rpmcmplib::rpmcmpd::ServerOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--allow-reload-path") {
+            options.allowReloadPath = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+
+        if (arg == "--socket") {
+            options.socketPath = argv[++i];
+        } else if (arg == "--table") {
+            options.tablePath = argv[++i];
+        } else if (arg == "--workers" && parseCount(argv[i + 1], options.workers)) {
+            ++i;
+        } else if (arg == "--batch" && parseCount(argv[i + 1], options.maxBatch)) {
+            ++i;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (options.socketPath.empty() || options.tablePath.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // signals are handled synchronously below, block them before any thread is started
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        rpmcmplib::rpmcmpd::Server server(options);
+        server.start();
+        std::cerr << "rpmcmpd: serving " << server.table()->size() << " records on " << options.socketPath << "\n";
+
+        while (true) {
+            int signal = 0;
+            sigwait(&signals, &signal);
+            if (signal != SIGHUP) {
+                break;
+            }
+
+            try {
+                std::cerr << "rpmcmpd: reloaded " << server.reload() << " records\n";
+            } catch (const std::exception& e) {
+                std::cerr << "rpmcmpd: reload failed, keeping current table: " << e.what() << "\n";
+            }
+        }
+
+        server.stop();
+    } catch (const std::exception& e) {
+        std::cerr << "rpmcmpd: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
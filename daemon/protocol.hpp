@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace rpmcmplib::rpmcmpd {
+
+/*
+ * Every message is a frame: u32 length of the rest of the frame, u32 request id
+ * and u8 opcode (request) or u8 status (response), followed by the body.
+ * Integers are little-endian, strings are u32 length followed by the bytes.
+ *
+ * Request bodies:
+ *   Compare: str lhs, str rhs                -> i8 result (-1, 0, 1)
+ *   Sort:    u32 n, n x str evr              -> u32 n, n x u32 index in ascending order
+ *   Newest:  str name                        -> str evr
+ *   Match:   str name, u8 constraint, str evr -> u32 n, n x str evr in ascending order
+ *   Reload:  str path (empty - same table)   -> u32 number of loaded records,
+ *            non-empty path is Forbidden unless daemon is started with --allow-reload-path
+ * Any response with non Ok status has body: str description of the error.
+ */
+
+constexpr uint32_t maxFrameSize = 16 * 1024 * 1024;
+constexpr size_t frameHeaderSize = 4;
+
+enum class Opcode : uint8_t {
+    Compare = 1,
+    Sort = 2,
+    Newest = 3,
+    Match = 4,
+    Reload = 5,
+};
+
+enum class Status : uint8_t {
+    Ok = 0,
+    BadRequest = 1,
+    InvalidEvr = 2,
+    NotFound = 3,
+    ReloadFailed = 4,
+    Forbidden = 5,
+};
+
+enum class Constraint : uint8_t {
+    Less = 1,
+    LessOrEqual = 2,
+    Equal = 3,
+    GreaterOrEqual = 4,
+    Greater = 5,
+};
+
+/**
+ * Serializes frame body, length prefix is patched by finish().
+ */
+class Writer {
+public:
+    Writer() {
+        u32(0);
+    }
+
+    Writer& u8(uint8_t value) {
+        m_buffer.push_back(value);
+        return *this;
+    }
+
+    Writer& u32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            m_buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+        return *this;
+    }
+
+    Writer& str(std::string_view value) {
+        u32(static_cast<uint32_t>(value.size()));
+        m_buffer.insert(m_buffer.end(), value.begin(), value.end());
+        return *this;
+    }
+
+    std::vector<uint8_t> finish() {
+        uint32_t length = static_cast<uint32_t>(m_buffer.size() - frameHeaderSize);
+        for (int i = 0; i < 4; ++i) {
+            m_buffer[i] = static_cast<uint8_t>(length >> (8 * i));
+        }
+        return std::move(m_buffer);
+    }
+
+private:
+    std::vector<uint8_t> m_buffer;
+};
+
+/**
+ * Deserializes frame body.
+ * 
+ * @throw invalid_argument if frame is shorter than requested value
+ */
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    uint8_t u8() {
+        require(1);
+        return m_data[m_pos++];
+    }
+
+    uint32_t u32() {
+        require(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(m_data[m_pos++]) << (8 * i);
+        }
+        return value;
+    }
+
+    std::string_view str() {
+        uint32_t length = u32();
+        require(length);
+        std::string_view value(reinterpret_cast<const char*>(m_data + m_pos), length);
+        m_pos += length;
+        return value;
+    }
+
+    bool atEnd() const {
+        return m_pos == m_size;
+    }
+
+private:
+    void require(size_t size) {
+        if (m_size - m_pos < size) {
+            throw std::invalid_argument("Truncated frame!");
+        }
+    }
+
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+};
+
+/**
+ * Get length of the frame body from its header.
+ */
+inline uint32_t frameLength(const uint8_t* header) {
+    return Reader(header, frameHeaderSize).u32();
+}
+
+} // namespace rpmcmplib::rpmcmpd
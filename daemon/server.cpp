@@ -0,0 +1,485 @@
+// SPDX-License-Identifier: MIT
+
+#include "server.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace rpmcmplib::rpmcmpd {
+
+namespace {
+
+/**
+ * Request can't be served, status and description are sent back to the client.
+ */
+class RequestError : public std::runtime_error {
+public:
+    RequestError(Status status, const std::string& what) : std::runtime_error(what), m_status(status) {}
+
+    Status status() const {
+        return m_status;
+    }
+
+private:
+    Status m_status;
+};
+
+RpmEvrView evrView(std::string_view evr) {
+    auto isValidCheckResult = RpmEvrView::isValid(evr);
+    if (!isValidCheckResult.empty()) {
+        throw RequestError(Status::InvalidEvr, isValidCheckResult);
+    }
+
+    return RpmEvrView(evr);
+}
+
+/**
+ * Find versions matching the constraint in versions sorted by EvrTable.
+ * 
+ * @return Range of indices [first, last) of matched versions.
+ */
+std::pair<size_t, size_t> matchRange(const std::vector<EvrParts>& versions, Constraint constraint, const EvrParts& evr) {
+    auto weakLess = [](const EvrParts& lhs, const EvrParts& rhs) {
+        return detail::weakOrderEvrs<DefaultPolicy>(lhs, rhs) < 0;
+    };
+    auto lower = static_cast<size_t>(std::lower_bound(versions.begin(), versions.end(), evr, weakLess) - versions.begin());
+    auto upper = static_cast<size_t>(std::upper_bound(versions.begin(), versions.end(), evr, weakLess) - versions.begin());
+
+    switch (constraint) {
+        case Constraint::Less:
+            return {0, lower};
+        case Constraint::LessOrEqual:
+            return {0, upper};
+        case Constraint::Equal:
+            return {lower, upper};
+        case Constraint::GreaterOrEqual:
+            return {lower, versions.size()};
+        case Constraint::Greater:
+            return {upper, versions.size()};
+    }
+
+    throw RequestError(Status::BadRequest, "Unknown constraint!");
+}
+
+} // namespace
+
+struct Server::Connection {
+    explicit Connection(int socketFd) : fd(socketFd) {}
+
+    ~Connection() {
+        ::close(fd);
+    }
+
+    /**
+     * Send as much of the output as the socket takes without blocking,
+     * must be called with mutex locked.
+     */
+    void flush() {
+        size_t sent = 0;
+        while (sent < output.size()) {
+            ssize_t result = ::send(fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (result <= 0) {
+                broken = true; // peer is gone, I/O thread drops the connection
+                output.clear();
+                return;
+            }
+            sent += static_cast<size_t>(result);
+        }
+        output.erase(output.begin(), output.begin() + static_cast<std::ptrdiff_t>(sent));
+    }
+
+    int fd;
+    std::vector<uint8_t> readBuffer; // touched only by I/O thread
+
+    std::mutex mutex; // guards the fields below
+    std::vector<uint8_t> output; // responses that aren't sent yet
+    size_t queued = 0; // frames that are queued or being answered
+    bool broken = false;
+};
+
+Server::Server(ServerOptions options)
+    : m_options(std::move(options)), m_table(EvrTable::load(m_options.tablePath)) {
+}
+
+Server::~Server() {
+    stop();
+}
+
+void Server::start() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (m_options.socketPath.empty() || m_options.socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid socket path " + m_options.socketPath);
+    }
+    std::memcpy(address.sun_path, m_options.socketPath.c_str(), m_options.socketPath.size() + 1);
+
+    m_listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listenFd < 0) {
+        throw std::system_error(errno, std::generic_category(), "socket");
+    }
+
+    ::unlink(m_options.socketPath.c_str());
+    if (::bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(m_listenFd, SOMAXCONN) < 0 ||
+        ::pipe2(m_wakeFds, O_CLOEXEC | O_NONBLOCK) < 0) {
+        int error = errno;
+        ::close(m_listenFd);
+        m_listenFd = -1;
+        throw std::system_error(error, std::generic_category(), "bind " + m_options.socketPath);
+    }
+
+    m_stopping = false;
+    m_ioThread = std::thread(&Server::ioLoop, this);
+    for (size_t i = 0; i < std::max<size_t>(1, m_options.workers); ++i) {
+        m_workers.emplace_back(&Server::workerLoop, this);
+    }
+}
+
+void Server::stop() {
+    if (m_listenFd < 0) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_queueMutex);
+        m_stopping = true;
+    }
+    m_queueCondition.notify_all();
+    wake();
+
+    m_ioThread.join();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+
+    ::close(m_listenFd);
+    ::close(m_wakeFds[0]);
+    ::close(m_wakeFds[1]);
+    m_listenFd = -1;
+    ::unlink(m_options.socketPath.c_str());
+}
+
+size_t Server::reload(const std::string& path) {
+    std::lock_guard lock(m_reloadMutex);
+    auto newTable = EvrTable::load(path.empty() ? table()->source() : path);
+    std::atomic_store(&m_table, newTable);
+    return newTable->size();
+}
+
+std::shared_ptr<const EvrTable> Server::table() const {
+    return std::atomic_load(&m_table);
+}
+
+void Server::ioLoop() {
+    std::unordered_map<int, std::shared_ptr<Connection>> connections;
+    std::vector<pollfd> fds;
+
+    while (!m_stopping) {
+        fds.clear();
+        fds.push_back({m_wakeFds[0], POLLIN, 0});
+        fds.push_back({m_listenFd, POLLIN, 0});
+        for (auto it = connections.begin(); it != connections.end();) {
+            auto& connection = it->second;
+            short events = 0;
+            try {
+                // frames left in the read buffer when connection was at its limit
+                queueFrames(connection);
+
+                std::lock_guard lock(connection->mutex);
+                if (connection->broken) {
+                    throw std::runtime_error("Connection closed");
+                }
+                if (connection->queued < m_options.maxQueuedFrames &&
+                    connection->output.size() < m_options.maxOutputBacklog) {
+                    events |= POLLIN;
+                }
+                if (!connection->output.empty()) {
+                    events |= POLLOUT;
+                }
+            } catch (const std::exception&) {
+                it = connections.erase(it);
+                continue;
+            }
+
+            fds.push_back({it->first, events, 0});
+            ++it;
+        }
+
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            continue; // EINTR
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            while (::read(m_wakeFds[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd >= 0) {
+                connections.emplace(fd, std::make_shared<Connection>(fd));
+            }
+        }
+
+        for (size_t i = 2; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+
+            auto it = connections.find(fds[i].fd);
+            try {
+                if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                    throw std::runtime_error("Connection closed");
+                }
+                if (fds[i].revents & POLLOUT) {
+                    std::lock_guard lock(it->second->mutex);
+                    it->second->flush();
+                }
+                if (fds[i].revents & POLLIN) {
+                    readConnection(it->second);
+                }
+            } catch (const std::exception&) {
+                connections.erase(it);
+            }
+        }
+    }
+}
+
+void Server::readConnection(const std::shared_ptr<Connection>& connection) {
+    uint8_t chunk[64 * 1024];
+    ssize_t received = ::recv(connection->fd, chunk, sizeof(chunk), 0);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return;
+    }
+    if (received <= 0) {
+        throw std::runtime_error("Connection closed");
+    }
+
+    auto& buffer = connection->readBuffer;
+    buffer.insert(buffer.end(), chunk, chunk + received);
+    queueFrames(connection);
+}
+
+void Server::queueFrames(const std::shared_ptr<Connection>& connection) {
+    auto& buffer = connection->readBuffer;
+    if (buffer.size() < frameHeaderSize) {
+        return;
+    }
+
+    size_t queued = 0;
+    {
+        std::lock_guard lock(connection->mutex);
+        queued = connection->queued;
+    }
+
+    size_t pos = 0;
+    std::vector<Request> requests;
+    while (queued + requests.size() < m_options.maxQueuedFrames && buffer.size() - pos >= frameHeaderSize) {
+        uint32_t length = frameLength(buffer.data() + pos);
+        if (length > maxFrameSize) {
+            throw std::runtime_error("Frame is too big");
+        }
+        if (buffer.size() - pos - frameHeaderSize < length) {
+            break;
+        }
+
+        auto frameBegin = buffer.begin() + static_cast<std::ptrdiff_t>(pos + frameHeaderSize);
+        requests.push_back({connection, std::vector<uint8_t>(frameBegin, frameBegin + length)});
+        pos += frameHeaderSize + length;
+    }
+    buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(pos));
+
+    if (!requests.empty()) {
+        {
+            std::lock_guard lock(connection->mutex);
+            connection->queued += requests.size();
+        }
+        {
+            std::lock_guard lock(m_queueMutex);
+            for (auto& request : requests) {
+                m_queue.push_back(std::move(request));
+            }
+        }
+        m_queueCondition.notify_all();
+    }
+}
+
+void Server::wake() {
+    // pipe is non-blocking: when it's full, I/O thread is going to wake up anyway
+    [[maybe_unused]] ssize_t result = ::write(m_wakeFds[1], "x", 1);
+}
+
+void Server::workerLoop() {
+    struct Output {
+        Connection* connection;
+        std::vector<uint8_t> data;
+        size_t frames;
+    };
+
+    while (true) {
+        std::vector<Request> batch;
+        {
+            std::unique_lock lock(m_queueMutex);
+            m_queueCondition.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;
+            }
+
+            size_t batchSize = std::min(m_queue.size(), std::max<size_t>(1, m_options.maxBatch));
+            for (size_t i = 0; i < batchSize; ++i) {
+                batch.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+        }
+
+        // whole batch is answered against one snapshot
+        auto snapshot = table();
+
+        std::vector<Output> output;
+        for (const auto& request : batch) {
+            auto response = handle(request.frame, *snapshot);
+            auto it = std::find_if(output.begin(), output.end(),
+                                   [&](const auto& item) { return item.connection == request.connection.get(); });
+            if (it == output.end()) {
+                output.push_back({request.connection.get(), std::move(response), 1});
+            } else {
+                it->data.insert(it->data.end(), response.begin(), response.end());
+                ++it->frames;
+            }
+        }
+
+        for (auto& [connection, data, frames] : output) {
+            bool needsIo = false;
+            {
+                std::lock_guard lock(connection->mutex);
+                bool paused = connection->queued >= m_options.maxQueuedFrames ||
+                              connection->output.size() >= m_options.maxOutputBacklog;
+                connection->queued -= frames;
+                if (!connection->broken) {
+                    connection->output.insert(connection->output.end(), data.begin(), data.end());
+                    connection->flush();
+                }
+
+                // I/O thread polls for the rest of output and resumes reading of paused connection
+                needsIo = paused || !connection->output.empty();
+            }
+            if (needsIo) {
+                wake();
+            }
+        }
+    }
+}
+
+std::vector<uint8_t> Server::handle(const std::vector<uint8_t>& frame, const EvrTable& table) {
+    Reader reader(frame.data(), frame.size());
+    uint32_t id = 0;
+
+    auto error = [&id](Status status, const std::string& what) {
+        return Writer().u32(id).u8(static_cast<uint8_t>(status)).str(what).finish();
+    };
+
+    try {
+        id = reader.u32();
+        auto opcode = static_cast<Opcode>(reader.u8());
+        Writer response;
+        response.u32(id).u8(static_cast<uint8_t>(Status::Ok));
+
+        switch (opcode) {
+            case Opcode::Compare: {
+                auto lhs = evrView(reader.str());
+                auto rhs = evrView(reader.str());
+                int result = RpmEvrView::cmp(lhs.evr(), rhs.evr());
+                response.u8(static_cast<uint8_t>(static_cast<int8_t>(result)));
+                break;
+            }
+            case Opcode::Sort: {
+                uint32_t count = reader.u32();
+                std::vector<RpmEvrView> evrs;
+                for (uint32_t i = 0; i < count; ++i) {
+                    evrs.push_back(evrView(reader.str()));
+                }
+
+                std::vector<uint32_t> order(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    order[i] = i;
+                }
+                std::stable_sort(order.begin(), order.end(),
+                                 [&evrs](uint32_t lhs, uint32_t rhs) { return evrs[lhs] < evrs[rhs]; });
+
+                response.u32(count);
+                for (uint32_t index : order) {
+                    response.u32(index);
+                }
+                break;
+            }
+            case Opcode::Newest: {
+                auto name = reader.str();
+                const RpmEvrView* newest = table.newest(name);
+                if (newest == nullptr) {
+                    throw RequestError(Status::NotFound, "Unknown package " + std::string(name));
+                }
+                response.str(newest->evr());
+                break;
+            }
+            case Opcode::Match: {
+                auto name = reader.str();
+                auto constraint = static_cast<Constraint>(reader.u8());
+                auto evr = evrView(reader.str());
+                const auto& versions = table.versions(name);
+                if (versions.empty()) {
+                    throw RequestError(Status::NotFound, "Unknown package " + std::string(name));
+                }
+
+                auto [first, last] = matchRange(table.parts(name), constraint, detail::splitEvr(evr.evr()));
+                response.u32(static_cast<uint32_t>(last - first));
+                for (size_t i = first; i < last; ++i) {
+                    response.str(versions[i].evr());
+                }
+                break;
+            }
+            case Opcode::Reload: {
+                auto path = reader.str();
+                if (!path.empty() && !m_options.allowReloadPath) {
+                    throw RequestError(Status::Forbidden, "Reload from another table file is not allowed!");
+                }
+                try {
+                    response.u32(static_cast<uint32_t>(reload(std::string(path))));
+                } catch (const std::exception& e) {
+                    throw RequestError(Status::ReloadFailed, e.what());
+                }
+                break;
+            }
+            default:
+                throw RequestError(Status::BadRequest, "Unknown opcode!");
+        }
+
+        if (!reader.atEnd()) {
+            throw RequestError(Status::BadRequest, "Unexpected data at the end of frame!");
+        }
+
+        return response.finish();
+    } catch (const RequestError& e) {
+        return error(e.status(), e.what());
+    } catch (const std::invalid_argument& e) {
+        return error(Status::BadRequest, e.what());
+    }
+}
+
+} // namespace rpmcmplib::rpmcmpd
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "evr_table.hpp"
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rpmcmplib::rpmcmpd {
+
+struct ServerOptions {
+    std::string socketPath;
+    std::string tablePath;
+    size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t maxBatch = 64;
+    size_t maxQueuedFrames = 256; // per connection, reading stops until some of them are answered
+    size_t maxOutputBacklog = 4 * 1024 * 1024; // per connection, reading stops until client reads responses
+    bool allowReloadPath = false; // whether clients may reload the table from another file
+};
+
+/**
+ * Comparison daemon serving queries over a Unix domain socket.
+ * 
+ * Single I/O thread reads frames from all connections and queues them,
+ * worker threads take queued requests in batches: the whole batch is
+ * answered against one table snapshot and responses for the same
+ * connection are sent with one write.
+ * Sockets are non-blocking: responses that client doesn't take are kept
+ * in the connection output buffer and flushed by the I/O thread, and
+ * the connection isn't read while it has too many queued frames or
+ * unsent bytes, so slow client never holds up workers.
+ * Reload builds new table aside and swaps it in, requests in flight
+ * finish against the snapshot they started with.
+ */
+class Server {
+public:
+
+    /**
+     * @throw runtime_error or invalid_argument if table can't be loaded
+     */
+    explicit Server(ServerOptions options);
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /**
+     * Bind the socket and start serving.
+     * 
+     * @throw system_error if socket can't be created
+     */
+    void start();
+
+    /**
+     * Stop serving and remove the socket, blocks until all threads are joined.
+     */
+    void stop();
+
+    /**
+     * Load table and replace the served one.
+     * 
+     * @param path - table file, empty path reloads current table source
+     * @return Number of records in the new table.
+     * @throw runtime_error or invalid_argument if table can't be loaded,
+     * currently served table is kept in this case
+     */
+    size_t reload(const std::string& path = "");
+
+    std::shared_ptr<const EvrTable> table() const;
+
+private:
+    struct Connection;
+
+    struct Request {
+        std::shared_ptr<Connection> connection;
+        std::vector<uint8_t> frame;
+    };
+
+    void ioLoop();
+    void workerLoop();
+    void readConnection(const std::shared_ptr<Connection>& connection);
+    void queueFrames(const std::shared_ptr<Connection>& connection);
+    void wake();
+    std::vector<uint8_t> handle(const std::vector<uint8_t>& frame, const EvrTable& table);
+
+    ServerOptions m_options;
+    std::shared_ptr<const EvrTable> m_table;
+    std::mutex m_reloadMutex;
+
+    int m_listenFd = -1;
+    int m_wakeFds[2] = {-1, -1};
+    std::atomic<bool> m_stopping = false;
+    std::thread m_ioThread;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueCondition;
+    std::deque<Request> m_queue;
+};
+
+} // namespace rpmcmplib::rpmcmpd
@@ -0,0 +1,599 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "reference.hpp"
+
+#include <rpmcmp.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Differential checks of all comparison engines against the reference implementation.
+ *
+ * Every check takes a list of input strings and returns the failure or nothing,
+ * inputs that a check doesn't apply to (wrong count, invalid for the engine) are skipped.
+ * Algebraic properties (antisymmetry, transitivity) are checked only for labels the
+ * order is defined for: rpmvercmp here deliberately treats any label with tilde as
+ * older and any label with caret as newer, so two labels that both have tilde (or
+ * both have caret) are "older" than each other.
+ */
+namespace rpmcmplib::fuzz {
+
+struct Failure {
+    std::string check;
+    std::vector<std::string> inputs;
+};
+
+using Check = std::function<std::optional<Failure>(const std::vector<std::string>& inputs)>;
+
+namespace detail {
+
+inline bool has(const std::string& label, char symbol) {
+    return label.find(symbol) != std::string::npos;
+}
+
+/**
+ * Check if labels order is defined: they aren't both with tilde or both with caret.
+ */
+inline bool orderable(const std::string& lhs, const std::string& rhs) {
+    if (has(lhs, '~') || has(rhs, '~')) {
+        return !(has(lhs, '~') && has(rhs, '~'));
+    }
+
+    return !(has(lhs, '^') && has(rhs, '^'));
+}
+
+inline bool orderable(const reference::Evr& lhs, const reference::Evr& rhs) {
+    return orderable(lhs.version, rhs.version) && orderable(lhs.release, rhs.release);
+}
+
+/**
+ * Expected validity message of EVR.
+ * Carve-out "epoch std::stoi threw for": the reference throws from std::stoi for epoch
+ * without leading number or out of int range, engines report such epoch as invalid instead.
+ */
+inline std::string referenceValidity(const std::string& evr) {
+    try {
+        return reference::isValidEvr(evr);
+    } catch (const std::invalid_argument&) {
+        return "Epoch must be a positive number!";
+    } catch (const std::out_of_range&) {
+        return "Epoch must be a positive number!";
+    }
+}
+
+inline bool referenceValid(const std::string& evr) {
+    return referenceValidity(evr).empty();
+}
+
+template <typename Evr>
+bool operatorsMatch(Evr lhs, Evr rhs, int expected) {
+    return (lhs < rhs) == (expected == -1) && (lhs > rhs) == (expected == 1) && (lhs == rhs) == (expected == 0);
+}
+
+inline std::optional<Failure> fail(const std::string& check, const std::vector<std::string>& inputs) {
+    return Failure{check, inputs};
+}
+
+} // namespace detail
+
+/**
+ * Compare labels (Version or Release) with all label engines.
+ *
+ * @param inputs - two labels
+ */
+inline std::optional<Failure> checkLabels(const std::vector<std::string>& inputs) {
+    if (inputs.size() != 2) {
+        return std::nullopt;
+    }
+    const auto& lhs = inputs[0];
+    const auto& rhs = inputs[1];
+
+    if (RpmVer::isValid(lhs) != reference::isValidLabel(lhs) || RpmVer::isValid(rhs) != reference::isValidLabel(rhs)) {
+        return detail::fail("RpmVer::isValid", inputs);
+    }
+    if (!reference::isValidLabel(lhs).empty() || !reference::isValidLabel(rhs).empty()) {
+        return std::nullopt;
+    }
+
+    if (RpmVer::segments(lhs) != reference::segments(lhs)) {
+        return detail::fail("RpmVer::segments", inputs);
+    }
+
+    int expected = reference::cmpLabels(lhs, rhs);
+    if (RpmVer::cmp(lhs, rhs) != expected) {
+        return detail::fail("RpmVer::cmp", inputs);
+    }
+    if (rpmcmplib::detail::cmpLabels(lhs, rhs) != expected) {
+        return detail::fail("detail::cmpLabels", inputs);
+    }
+    if (!detail::operatorsMatch(RpmVer(lhs), RpmVer(rhs), expected)) {
+        return detail::fail("RpmVer operators", inputs);
+    }
+
+    if (detail::orderable(lhs, rhs) && rpmcmplib::detail::cmpLabels(rhs, lhs) != -expected) {
+        return detail::fail("label antisymmetry", inputs);
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * Validate, split and compare EVRs with all EVR engines.
+ *
+ * @param inputs - two EVRs
+ */
+inline std::optional<Failure> checkEvrs(const std::vector<std::string>& inputs) {
+    if (inputs.size() != 2) {
+        return std::nullopt;
+    }
+
+    bool comparable = true;
+    for (const auto& evr : inputs) {
+        auto expectedValidity = detail::referenceValidity(evr);
+        if (RpmEvr::isValid(evr) != expectedValidity) {
+            return detail::fail("RpmEvr::isValid", inputs);
+        }
+        if (RpmEvrView::isValid(evr) != expectedValidity) {
+            return detail::fail("RpmEvrView::isValid", inputs);
+        }
+        if (!expectedValidity.empty()) {
+            comparable = false;
+            continue;
+        }
+
+        auto expectedParts = reference::parseEvr(evr);
+        RpmEvr rpmEvr(evr);
+        RpmEvrView view(evr);
+        if (rpmEvr.epoch() != expectedParts.epoch || rpmEvr.version() != expectedParts.version ||
+            rpmEvr.release() != expectedParts.release) {
+            return detail::fail("RpmEvr split", inputs);
+        }
+        if (view.epoch() != expectedParts.epoch || view.version() != expectedParts.version ||
+            view.release() != expectedParts.release) {
+            return detail::fail("RpmEvrView split", inputs);
+        }
+    }
+
+    if (!comparable) {
+        return std::nullopt;
+    }
+
+    const auto& lhs = inputs[0];
+    const auto& rhs = inputs[1];
+    int expected = reference::cmpEvrs(reference::parseEvr(lhs), reference::parseEvr(rhs));
+
+    if (RpmEvr::cmp(lhs, rhs) != expected) {
+        return detail::fail("RpmEvr::cmp", inputs);
+    }
+    if (!detail::operatorsMatch(RpmEvr(lhs), RpmEvr(rhs), expected)) {
+        return detail::fail("RpmEvr operators", inputs);
+    }
+    if (RpmEvrView::cmp(lhs, rhs) != expected) {
+        return detail::fail("RpmEvrView::cmp", inputs);
+    }
+    if (!detail::operatorsMatch(RpmEvrView(lhs), RpmEvrView(rhs), expected)) {
+        return detail::fail("RpmEvrView operators", inputs);
+    }
+
+    auto lhsParts = rpmcmplib::detail::splitEvr(lhs);
+    auto rhsParts = rpmcmplib::detail::splitEvr(rhs);
+    if (EvrParts::cmp(lhsParts, rhsParts) != expected) {
+        return detail::fail("EvrParts::cmp", inputs);
+    }
+    if (!detail::operatorsMatch(lhsParts, rhsParts, expected)) {
+        return detail::fail("EvrParts operators", inputs);
+    }
+
+    if (detail::orderable(reference::parseEvr(lhs), reference::parseEvr(rhs)) &&
+        RpmEvrView::cmp(rhs, lhs) != -expected) {
+        return detail::fail("EVR antisymmetry", inputs);
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * Check transitivity of EVR order.
+ *
+ * @param inputs - three EVRs
+ */
+inline std::optional<Failure> checkTransitivity(const std::vector<std::string>& inputs) {
+    if (inputs.size() != 3) {
+        return std::nullopt;
+    }
+
+    std::vector<reference::Evr> parts;
+    for (const auto& evr : inputs) {
+        if (!detail::referenceValid(evr)) {
+            return std::nullopt;
+        }
+        parts.push_back(reference::parseEvr(evr));
+    }
+    for (size_t i = 0; i < parts.size(); ++i) {
+        if (!detail::orderable(parts[i], parts[(i + 1) % parts.size()])) {
+            return std::nullopt;
+        }
+    }
+
+    int ab = RpmEvrView::cmp(inputs[0], inputs[1]);
+    int bc = RpmEvrView::cmp(inputs[1], inputs[2]);
+    int ac = RpmEvrView::cmp(inputs[0], inputs[2]);
+
+    // a <= b <= c => a <= c, strictly if any step is strict; same for >=
+    for (int direction : {1, -1}) {
+        if (direction * ab <= 0 && direction * bc <= 0) {
+            int expected = (ab == 0 && bc == 0) ? 0 : -direction;
+            if (ac != expected) {
+                return detail::fail("EVR transitivity", inputs);
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * Check selection algorithms against the reference sort.
+ *
+ * @param inputs - any number of EVRs
+ */
+inline std::optional<Failure> checkSelection(const std::vector<std::string>& inputs) {
+    std::vector<reference::Evr> parts;
+    for (const auto& evr : inputs) {
+        if (!detail::referenceValid(evr)) {
+            return std::nullopt;
+        }
+        parts.push_back(reference::parseEvr(evr));
+    }
+    // label with tilde or caret isn't even equal to itself
+    for (size_t i = 0; i < parts.size(); ++i) {
+        for (size_t j = i; j < parts.size(); ++j) {
+            if (!detail::orderable(parts[i], parts[j])) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    auto cmp = [&parts](size_t lhs, size_t rhs) { return reference::cmpEvrs(parts[lhs], parts[rhs]); };
+    auto same = [&](const std::string& lhs, const std::string& rhs) {
+        return reference::cmpEvrs(reference::parseEvr(lhs), reference::parseEvr(rhs)) == 0;
+    };
+
+    size_t expectedMax = 0;
+    for (size_t i = 1; i < parts.size(); ++i) {
+        if (cmp(i, expectedMax) > 0) {
+            expectedMax = i;
+        }
+    }
+    std::vector<RpmEvrView> views(inputs.begin(), inputs.end());
+    std::vector<RpmEvr> rpmEvrs(inputs.begin(), inputs.end());
+    if (static_cast<size_t>(maxElement(inputs) - inputs.begin()) != (inputs.empty() ? 0 : expectedMax) ||
+        static_cast<size_t>(maxElement(views) - views.begin()) != (inputs.empty() ? 0 : expectedMax) ||
+        static_cast<size_t>(maxElement(rpmEvrs) - rpmEvrs.begin()) != (inputs.empty() ? 0 : expectedMax)) {
+        return detail::fail("maxElement", inputs);
+    }
+
+    std::vector<size_t> order(parts.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&cmp](size_t lhs, size_t rhs) { return cmp(lhs, rhs) < 0; });
+
+    for (size_t k : {size_t(0), size_t(1), inputs.size() / 2, inputs.size(), inputs.size() + 1}) {
+        auto actualNewest = newest(inputs, k);
+        auto actualOldest = oldest(inputs, k);
+        TopK<std::string> accumulator(k);
+        for (const auto& evr : inputs) {
+            accumulator.push(evr);
+        }
+        auto actualStreamed = accumulator.take();
+
+        size_t expectedSize = std::min(k, inputs.size());
+        if (actualNewest.size() != expectedSize || actualOldest.size() != expectedSize ||
+            actualStreamed.size() != expectedSize) {
+            return detail::fail("newest/oldest/TopK size", inputs);
+        }
+        for (size_t i = 0; i < expectedSize; ++i) {
+            if (!same(actualNewest[i], inputs[order[order.size() - 1 - i]])) {
+                return detail::fail("newest", inputs);
+            }
+            if (!same(actualOldest[i], inputs[order[i]])) {
+                return detail::fail("oldest", inputs);
+            }
+            if (!same(actualStreamed[i], inputs[order[order.size() - 1 - i]])) {
+                return detail::fail("TopK", inputs);
+            }
+        }
+    }
+
+    for (size_t n = 0; n < inputs.size(); n += std::max<size_t>(1, inputs.size() / 4)) {
+        auto arranged = inputs;
+        nthElement(arranged, n);
+        if (!same(arranged[n], inputs[order[n]])) {
+            return detail::fail("nthElement", inputs);
+        }
+        for (size_t i = 0; i < arranged.size(); ++i) {
+            int comparison = reference::cmpEvrs(reference::parseEvr(arranged[i]), reference::parseEvr(arranged[n]));
+            if ((i < n && comparison > 0) || (i > n && comparison < 0)) {
+                return detail::fail("nthElement partition", inputs);
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * Compare labels and EVRs with UpstreamPolicy engines against the reference
+ * written from documentation of upstream RPM.
+ *
+ * @param inputs - two labels or EVRs, three for transitivity
+ */
+inline std::optional<Failure> checkUpstream(const std::vector<std::string>& inputs) {
+    using UpstreamRpmVer = BasicRpmVer<UpstreamPolicy>;
+    using UpstreamRpmEvr = BasicRpmEvr<UpstreamPolicy>;
+    using UpstreamRpmEvrView = BasicRpmEvrView<UpstreamPolicy>;
+
+    if (inputs.size() == 2) {
+        const auto& lhs = inputs[0];
+        const auto& rhs = inputs[1];
+        int expected = reference::upstreamCmpLabels(lhs, rhs);
+        if (UpstreamPolicy::cmpLabels(lhs, rhs) != expected) {
+            return detail::fail("UpstreamPolicy::cmpLabels", inputs);
+        }
+        if (UpstreamPolicy::cmpLabels(rhs, lhs) != -expected) {
+            return detail::fail("upstream label antisymmetry", inputs);
+        }
+        if (UpstreamRpmVer::isValid(lhs).empty() && UpstreamRpmVer::isValid(rhs).empty() &&
+            UpstreamRpmVer::cmp(lhs, rhs) != expected) {
+            return detail::fail("BasicRpmVer<UpstreamPolicy>::cmp", inputs);
+        }
+    }
+
+    std::vector<reference::Evr> parts;
+    for (const auto& evr : inputs) {
+        if (!detail::referenceValid(evr)) {
+            return std::nullopt;
+        }
+        parts.push_back(reference::parseEvr(evr));
+    }
+    auto cmp = [](const reference::Evr& lhs, const reference::Evr& rhs) {
+        if (lhs.epoch != rhs.epoch) {
+            return lhs.epoch > rhs.epoch ? 1 : -1;
+        }
+        int versionComparison = reference::upstreamCmpLabels(lhs.version, rhs.version);
+        return versionComparison != 0 ? versionComparison : reference::upstreamCmpLabels(lhs.release, rhs.release);
+    };
+
+    if (inputs.size() == 2) {
+        int expected = cmp(parts[0], parts[1]);
+        if (UpstreamRpmEvr::cmp(inputs[0], inputs[1]) != expected) {
+            return detail::fail("BasicRpmEvr<UpstreamPolicy>::cmp", inputs);
+        }
+        if (!detail::operatorsMatch(UpstreamRpmEvr(inputs[0]), UpstreamRpmEvr(inputs[1]), expected)) {
+            return detail::fail("BasicRpmEvr<UpstreamPolicy> operators", inputs);
+        }
+        if (UpstreamRpmEvrView::cmp(inputs[0], inputs[1]) != expected) {
+            return detail::fail("BasicRpmEvrView<UpstreamPolicy>::cmp", inputs);
+        }
+    } else if (inputs.size() == 3) {
+        int ab = UpstreamRpmEvrView::cmp(inputs[0], inputs[1]);
+        int bc = UpstreamRpmEvrView::cmp(inputs[1], inputs[2]);
+        int ac = UpstreamRpmEvrView::cmp(inputs[0], inputs[2]);
+        for (int direction : {1, -1}) {
+            if (direction * ab <= 0 && direction * bc <= 0) {
+                int expected = (ab == 0 && bc == 0) ? 0 : -direction;
+                if (ac != expected) {
+                    return detail::fail("upstream EVR transitivity", inputs);
+                }
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * Run all checks that apply to the number of inputs.
+ */
+inline std::optional<Failure> checkAll(const std::vector<std::string>& inputs) {
+    for (const auto& check : {checkLabels, checkEvrs, checkTransitivity, checkSelection, checkUpstream}) {
+        if (auto failure = check(inputs)) {
+            return failure;
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * Shrink failing inputs: drop whole inputs and single characters
+ * while the same check still fails.
+ */
+inline Failure minimize(Failure failure, const Check& check) {
+    auto stillFails = [&](const std::vector<std::string>& inputs) {
+        auto result = check(inputs);
+        return result && result->check == failure.check;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < failure.inputs.size(); ++i) {
+            auto candidate = failure.inputs;
+            candidate.erase(candidate.begin() + static_cast<std::ptrdiff_t>(i));
+            if (stillFails(candidate)) {
+                failure.inputs = std::move(candidate);
+                changed = true;
+                --i;
+            }
+        }
+
+        for (size_t i = 0; i < failure.inputs.size(); ++i) {
+            for (size_t j = 0; j < failure.inputs[i].size(); ++j) {
+                auto candidate = failure.inputs;
+                candidate[i].erase(j, 1);
+                if (stillFails(candidate)) {
+                    failure.inputs = std::move(candidate);
+                    changed = true;
+                    --j;
+                }
+            }
+        }
+    }
+
+    return failure;
+}
+
+inline std::string describe(const Failure& failure) {
+    std::ostringstream description;
+    description << "check failed: " << failure.check << "\n";
+    for (const auto& input : failure.inputs) {
+        description << "  \"";
+        for (unsigned char symbol : input) {
+            if (symbol < 0x20 || symbol >= 0x7f || symbol == '"' || symbol == '\\') {
+                const char* digits = "0123456789abcdef";
+                description << "\\x" << digits[symbol >> 4] << digits[symbol & 0xf];
+            } else {
+                description << symbol;
+            }
+        }
+        description << "\"\n";
+    }
+
+    return description.str();
+}
+
+/**
+ * Random labels and EVRs biased to produce equal and nearly equal values:
+ * segments are drawn from small pools, leading zeros, numbers that don't fit
+ * into long long, non-ASCII bytes, tilde and caret are mixed in.
+ */
+class Generator {
+public:
+    explicit Generator(uint64_t seed) : m_random(seed) {}
+
+    std::string label() {
+        static const char* numbers[] = {"0", "1", "2", "9", "10", "01", "001", "0010", "99999999999999999999"};
+        static const char* words[] = {"a", "b", "rc", "fc", "post", "A", "Z", "git", "\xc3\xa9"};
+        static const char separators[] = {'.', '.', '.', '_', '+', '~', '^'};
+
+        std::string result;
+        size_t count = 1 + pick(4);
+        for (size_t i = 0; i < count; ++i) {
+            if (i > 0 && pick(3) != 0) {
+                result += separators[pick(sizeof(separators))];
+            }
+            result += pick(3) == 0 ? words[pick(std::size(words))] : numbers[pick(std::size(numbers))];
+        }
+
+        return result;
+    }
+
+    std::string evr() {
+        std::string result;
+        if (pick(3) == 0) {
+            static const char* epochs[] = {"0", "1", "2", "01", "2147483647", "2147483648", "99999999999",
+                                           "", " 1", "+1", "1a", "-0"};
+            result += std::string(epochs[pick(std::size(epochs))]) + ":";
+        }
+
+        result += label();
+        if (pick(3) != 0) {
+            result += "-" + label();
+        }
+
+        return pick(16) == 0 ? mutate(result) : result;
+    }
+
+    /**
+     * Change one character of the value, e.g. to get EVR with extra colon or hyphen.
+     */
+    std::string mutate(std::string value) {
+        static const char symbols[] = {':', '-', '.', '0', '1', 'a', '~', '^', ' ', '+'};
+        size_t pos = pick(value.size() + 1);
+        switch (pick(3)) {
+            case 0:
+                value.insert(pos, 1, symbols[pick(sizeof(symbols))]);
+                break;
+            case 1:
+                if (pos < value.size()) {
+                    value.erase(pos, 1);
+                }
+                break;
+            default:
+                if (pos < value.size()) {
+                    value[pos] = symbols[pick(sizeof(symbols))];
+                }
+        }
+
+        return value;
+    }
+
+    /**
+     * Get random number in [0, bound).
+     */
+    size_t pick(size_t bound) {
+        return std::uniform_int_distribution<size_t>(0, bound - 1)(m_random);
+    }
+
+private:
+    std::mt19937_64 m_random;
+};
+
+/**
+ * Run all checks on random inputs.
+ *
+ * @return Minimized first failure or nothing if all checks passed.
+ */
+inline std::optional<Failure> runRandom(uint64_t seed, size_t iterations) {
+    Generator generator(seed);
+    auto run = [](const std::vector<std::string>& inputs) -> std::optional<Failure> {
+        if (auto failure = checkAll(inputs)) {
+            return minimize(*failure, checkAll);
+        }
+        return std::nullopt;
+    };
+
+    for (size_t i = 0; i < iterations; ++i) {
+        std::string lhsLabel = generator.label();
+        std::string rhsLabel = generator.pick(2) == 0 ? generator.mutate(lhsLabel) : generator.label();
+        std::string lhs = generator.evr();
+        std::string rhs = generator.pick(2) == 0 ? generator.mutate(lhs) : generator.evr();
+        std::string third = generator.pick(2) == 0 ? generator.mutate(rhs) : generator.evr();
+
+        for (const auto& inputs : {std::vector<std::string>{lhsLabel, rhsLabel},
+                                   std::vector<std::string>{lhs, rhs},
+                                   std::vector<std::string>{lhs, rhs, third}}) {
+            if (auto failure = run(inputs)) {
+                return failure;
+            }
+        }
+
+        if (i % 16 == 0) {
+            std::vector<std::string> inputs;
+            size_t count = generator.pick(24);
+            for (size_t j = 0; j < count; ++j) {
+                inputs.push_back(generator.pick(4) == 0 && j > 0 ? generator.mutate(inputs[j - 1]) : generator.evr());
+            }
+            if (auto failure = run(inputs)) {
+                return failure;
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
+} // namespace rpmcmplib::fuzz
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: MIT
+
+#include "differential.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * Input is split by new lines: two lines are checked as labels and as EVRs,
+ * three lines for transitivity, any number of lines for selection algorithms.
+ * libFuzzer minimizes crashing inputs itself (-minimize_crash=1), the harness
+ * prints its own minimized inputs as well.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::vector<std::string> inputs(1);
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] == '\n') {
+            inputs.emplace_back();
+        } else {
+            inputs.back().push_back(static_cast<char>(data[i]));
+        }
+    }
+
+    if (auto failure = rpmcmplib::fuzz::checkAll(inputs)) {
+        std::cerr << rpmcmplib::fuzz::describe(rpmcmplib::fuzz::minimize(*failure, rpmcmplib::fuzz::checkAll));
+        std::abort();
+    }
+
+    return 0;
+}
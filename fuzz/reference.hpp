@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Reference implementation for differential checks: the original
+ * RpmVer::cmp_impl/RpmEvr::cmp_impl algorithm, kept as is (segment vectors,
+ * string copies and all) so that every optimized engine can be compared to it,
+ * and label comparison of upstream RPM for UpstreamPolicy written independently
+ * from its documentation.
+ * Don't optimize this file.
+ */
+namespace rpmcmplib::reference {
+
+inline bool contains(const std::string& str, const std::string& substr) {
+    return (str.find(substr) != std::string::npos);
+}
+
+inline std::string isValidLabel(const std::string& label) {
+    if (label.find("-") != std::string::npos) {
+        return "Label can't have hyphen symbol!";
+    }
+
+    return "";
+}
+
+/**
+ * @throw invalid_argument or out_of_range from std::stoi for invalid epoch
+ */
+inline std::string isValidEvr(const std::string& evr) {
+    if (std::count(evr.cbegin(), evr.cend(), ':') > 1) {
+        return "EVR must contain only one colon symbol!";
+    }
+
+    if (contains(evr, ":")) {
+        if (std::stoi(evr.substr(0, evr.find(':'))) < 0) {
+            return "Epoch must be a positive number!";
+        }
+    }
+
+    if (std::count(evr.cbegin(), evr.cend(), '-') > 1) {
+        return "EVR must contain only one hyphen symbol!";
+    }
+
+    return "";
+}
+
+inline std::vector<std::string_view> segments(std::string_view label) {
+    std::vector<std::string_view> segmentsVector;
+    std::string_view segment;
+    for(size_t i = 0; i < label.size(); ++i) {
+        if ( std::isdigit(label.at(i)) || std::isalpha(label.at(i)) ) {
+            if (segment.empty()) {
+                segment = label.substr(i, 1);
+            } else if ( (std::isdigit(label.at(i)) && std::isdigit(segment.back())) ||
+                        (std::isalpha(label.at(i)) && std::isalpha(segment.back())) ) {
+                segment = {segment.data(), segment.size() + 1};
+            } else {
+                segmentsVector.push_back(segment);
+                segment = label.substr(i, 1);
+            }
+        } else {
+            if (!segment.empty()) {
+                segmentsVector.push_back(segment);
+                segment = {"", 0};
+            }
+        }
+    }
+
+    if (!segment.empty()) {
+        segmentsVector.push_back(segment);
+    }
+
+    return segmentsVector;
+}
+
+inline int cmpLabels(const std::string& lhs, const std::string& rhs) {
+    // check for tilde and caret
+    if (contains(lhs, "~")) {
+        return -1;
+    } else if (contains(rhs, "~")) {
+        return 1;
+    }
+
+    if (contains(lhs, "^")) {
+        return 1;
+    } else if (contains(rhs, "^")) {
+        return -1;
+    }
+
+    // split into segments
+    auto lhsSegments = segments(lhs);
+    auto rhsSegments = segments(rhs);
+
+    // compare segments
+    size_t length = std::min(lhsSegments.size(), rhsSegments.size());
+    for (size_t i = 0; i < length; ++i) {
+        long long int lhsNumber = 0;
+        long long int rhsNumber = 0;
+        bool lhsIsNumber = true;
+        bool rhsIsNumber = true;
+
+        auto [lhsPtr, lhsEc] = std::from_chars(lhsSegments.at(i).data(),
+                                               lhsSegments.at(i).data() + lhsSegments.at(i).size(),
+                                               lhsNumber);
+        if (lhsEc != std::errc()) {
+            lhsIsNumber = false;
+        }
+
+        auto [rhsPtr, rhsEc] = std::from_chars(rhsSegments.at(i).data(),
+                                               rhsSegments.at(i).data() + rhsSegments.at(i).size(),
+                                               rhsNumber);
+        if (rhsEc != std::errc()) {
+            rhsIsNumber = false;
+        }
+
+        if (lhsIsNumber && rhsIsNumber) { // compare as numeric
+            if (lhsNumber > rhsNumber) {
+                return 1;
+            } else if (lhsNumber < rhsNumber) {
+                return -1;
+            }
+        } else if (!lhsIsNumber && !rhsIsNumber) { // compare as alphabetic
+            if (lhsSegments.at(i) != rhsSegments.at(i)) {
+                if (lhsSegments.at(i).compare(rhsSegments.at(i)) < 0) {
+                    return -1;
+                } else {
+                    return 1;
+                }
+            }
+        } else { // numeric elements is newer than alphabetic
+            if(lhsIsNumber) {
+                return 1;
+            } else if (rhsIsNumber) {
+                return -1;
+            }
+        }
+    }
+
+    // if segments are equal then longer segment wins
+    if(lhsSegments.size() == rhsSegments.size()) {
+        return 0;
+    } else if (lhsSegments.size() > rhsSegments.size()) {
+        return 1;
+    }
+
+    return -1;
+}
+
+struct Evr {
+    unsigned long long int epoch = 0;
+    std::string version;
+    std::string release;
+};
+
+inline Evr parseEvr(const std::string& evr) {
+    Evr parsed;
+    if (contains(evr, ":")) {
+        parsed.epoch = std::stoul(evr.substr(0, evr.find(':')));
+    }
+
+    if (contains(evr, "-")) {
+        size_t versionStart = (evr.find(':') == evr.npos) ? 0 : evr.find(':') + 1;
+        size_t versionSize = evr.find('-') - versionStart;
+        parsed.version = evr.substr(versionStart, versionSize);
+        parsed.release = evr.substr(evr.find('-')+1, evr.size());
+    } else if (contains(evr, ":")) {
+        parsed.version = evr.substr(evr.find(':')+1, evr.size());
+    } else {
+        parsed.version = evr;
+    }
+
+    return parsed;
+}
+
+inline int cmpEvrs(const Evr& lhs, const Evr& rhs) {
+    if (lhs.epoch > rhs.epoch) {
+        return 1;
+    } else if (lhs.epoch < rhs.epoch) {
+        return -1;
+    }
+
+    int versionComparison = cmpLabels(lhs.version, rhs.version);
+    if ( versionComparison != 0) {
+        return versionComparison;
+    }
+
+    return cmpLabels(lhs.release, rhs.release);
+}
+
+/**
+ * Tokens of the label as described in RPM Versioning: runs of digits, runs of
+ * ASCII letters, tilde and caret, everything else only separates tokens.
+ */
+inline std::vector<std::string> upstreamTokens(const std::string& label) {
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+    auto isAlpha = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); };
+
+    std::vector<std::string> tokens;
+    std::string current;
+    for (char c : label) {
+        bool continues = !current.empty() &&
+            ((isDigit(c) && isDigit(current.back())) || (isAlpha(c) && isAlpha(current.back())));
+        if (!continues && !current.empty()) {
+            tokens.push_back(current);
+            current.clear();
+        }
+
+        if (c == '~' || c == '^') {
+            tokens.push_back(std::string(1, c));
+        } else if (isDigit(c) || isAlpha(c)) {
+            current += c;
+        }
+    }
+    if (!current.empty()) {
+        tokens.push_back(current);
+    }
+
+    return tokens;
+}
+
+/**
+ * Label comparison of upstream RPM written from RPM Versioning and Fedora
+ * Versioning Guidelines: tokens are compared pairwise, tilde sorts before
+ * anything including the end of the label, caret sorts after the end of the label
+ * but before anything else, numbers are newer than letters and are compared
+ * by value (of any length), letters are compared with strcmp, and the label
+ * with tokens left wins.
+ */
+inline int upstreamCmpLabels(const std::string& lhs, const std::string& rhs) {
+    std::vector<std::string> lhsTokens = upstreamTokens(lhs);
+    std::vector<std::string> rhsTokens = upstreamTokens(rhs);
+
+    // end of the label is represented by empty token
+    for (size_t i = 0; i < std::max(lhsTokens.size(), rhsTokens.size()); ++i) {
+        std::string a = i < lhsTokens.size() ? lhsTokens[i] : "";
+        std::string b = i < rhsTokens.size() ? rhsTokens[i] : "";
+        if (a == b) {
+            continue;
+        }
+
+        if (a == "~" || b == "~") {
+            return a == "~" ? -1 : 1;
+        }
+        if (a.empty() || b.empty()) {
+            if (a == "^" || b == "^") {
+                return a == "^" ? 1 : -1;
+            }
+            return a.empty() ? -1 : 1;
+        }
+        if (a == "^" || b == "^") {
+            return a == "^" ? -1 : 1;
+        }
+
+        bool aIsNumber = std::isdigit(static_cast<unsigned char>(a[0]));
+        bool bIsNumber = std::isdigit(static_cast<unsigned char>(b[0]));
+        if (aIsNumber != bIsNumber) {
+            return aIsNumber ? 1 : -1;
+        }
+
+        if (aIsNumber) {
+            a.erase(0, std::min(a.find_first_not_of('0'), a.size()));
+            b.erase(0, std::min(b.find_first_not_of('0'), b.size()));
+            if (a.size() != b.size()) {
+                return a.size() > b.size() ? 1 : -1;
+            }
+        }
+
+        if (a != b) {
+            return a < b ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace rpmcmplib::reference
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MIT
+
+#include "differential.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--iterations N] [--seed S] [CORPUS_FILE...]\n"
+              << "\n"
+              << "Check all comparison engines against the reference implementation on random inputs\n"
+              << "and on corpus files (one label or EVR per line: every pair, every consecutive triple\n"
+              << "and whole file are checked). Failing inputs are minimized and printed.\n";
+}
+
+std::optional<rpmcmplib::fuzz::Failure> checkCorpus(const std::vector<std::string>& lines) {
+    auto run = [](const std::vector<std::string>& inputs) -> std::optional<rpmcmplib::fuzz::Failure> {
+        if (auto failure = rpmcmplib::fuzz::checkAll(inputs)) {
+            return rpmcmplib::fuzz::minimize(*failure, rpmcmplib::fuzz::checkAll);
+        }
+        return std::nullopt;
+    };
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        for (size_t j = 0; j < lines.size(); ++j) {
+            if (auto failure = run({lines[i], lines[j]})) {
+                return failure;
+            }
+        }
+        if (i + 2 < lines.size()) {
+            if (auto failure = run({lines[i], lines[i + 1], lines[i + 2]})) {
+                return failure;
+            }
+        }
+    }
+
+    return run(lines);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = 100000;
+    uint64_t seed = 1;
+    std::vector<std::string> corpusFiles;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--iterations" || arg == "--seed") && i + 1 < argc) {
+            (arg == "--iterations" ? iterations : seed) = std::stoull(argv[++i]);
+        } else if (arg.rfind("--", 0) == 0) {
+            usage(argv[0]);
+            return 2;
+        } else {
+            corpusFiles.push_back(arg);
+        }
+    }
+
+    for (const auto& path : corpusFiles) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Can't open " << path << "\n";
+            return 2;
+        }
+
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(file, line);) {
+            lines.push_back(line);
+        }
+
+        if (auto failure = checkCorpus(lines)) {
+            std::cerr << path << ": " << rpmcmplib::fuzz::describe(*failure);
+            return 1;
+        }
+    }
+
+    if (auto failure = rpmcmplib::fuzz::runRandom(seed, iterations)) {
+        std::cerr << "seed " << seed << ": " << rpmcmplib::fuzz::describe(*failure);
+        return 1;
+    }
+
+    std::cout << "OK: " << iterations << " random iterations (seed " << seed << "), "
+              << corpusFiles.size() << " corpus files\n";
+    return 0;
+}
@@ -3,29 +3,454 @@
 #pragma once
 
 #include <algorithm>
+#include <cctype>
 #include <charconv>
+#include <deque>
+#include <limits>
+#include <memory_resource>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace rpmcmplib {
 
 namespace utils {
 
-bool contains(const std::string& str, const std::string& substr) {
+inline bool contains(const std::string& str, const std::string& substr) {
     return (str.find(substr) != std::string::npos);
 }
 
 } // namespace utils
 
-class RpmVer {
+/**
+ * Pre-parsed EVR: epoch and views of version and release stored elsewhere
+ * (e.g. in EVR string or in a batch of repository metadata records).
+ * Views must outlive the parts, parts aren't validated.
+ */
+struct EvrParts {
+    unsigned long long int epoch = 0;
+    std::string_view version;
+    std::string_view release;
+
+    /**
+     * Compare the EVR parts.
+     * 
+     * @return comparison result:
+     *   1  if lhs > rhs
+     *   0  if lhs == rhs
+     *  -1  if lhs < rhs
+     */
+    static int cmp(const EvrParts& lhs, const EvrParts& rhs);
+
+    bool operator>(const EvrParts& other) const;
+    bool operator<(const EvrParts& other) const;
+    bool operator==(const EvrParts& other) const;
+
+    bool operator>=(const EvrParts& other) const = delete;
+    bool operator<=(const EvrParts& other) const = delete;
+};
+
+/*
+ * Comparison policies define how labels (Version or Release) are compared.
+ * BasicRpmVer, BasicRpmEvr and BasicRpmEvrView take the policy as template argument,
+ * so each instantiation has its own comparison loop without run-time switches.
+ * Policy provides:
+ *   static int cmpLabels(std::string_view lhs, std::string_view rhs);
+ *   static constexpr bool wholeLabelMarkers - whether label with tilde (caret) is older (newer)
+ *   than any label without it, wherever the symbol is.
+ */
+
+/**
+ * Comparison of this library, see rpmvercmp algorithm in README.
+ */
+struct DefaultPolicy {
+    static constexpr bool wholeLabelMarkers = true;
+
+    static int cmpLabels(std::string_view lhs, std::string_view rhs);
+};
+
+/**
+ * Comparison of upstream RPM as described in RPM Versioning and Fedora Versioning Guidelines:
+ * tilde and caret are compared at their positions (`1.0~rc1` < `1.0~rc2`,
+ * `0.4.1^x` < `0.4.1.y`), numbers of any length are compared by length
+ * after stripping leading zeros and then with strcmp.
+ */
+struct UpstreamPolicy {
+    static constexpr bool wholeLabelMarkers = false;
+
+    static int cmpLabels(std::string_view lhs, std::string_view rhs);
+};
+
+namespace detail {
+
+inline bool isDigit(char c) {
+    return std::isdigit(static_cast<unsigned char>(c));
+}
+
+inline bool isAlpha(char c) {
+    return std::isalpha(static_cast<unsigned char>(c));
+}
+
+/**
+ * Parse epoch: decimal number without sign or spaces that fits into int, like epoch of RPM header.
+ * 
+ * @param epoch - epoch text
+ * @param value - parsed epoch, not changed if epoch is invalid
+ * @return Whether epoch is valid.
+ */
+inline bool parseEpoch(std::string_view epoch, unsigned long long int& value) {
+    int number = 0;
+    auto [ptr, ec] = std::from_chars(epoch.data(), epoch.data() + epoch.size(), number);
+    if (epoch.empty() || !isDigit(epoch.front()) || ec != std::errc() || ptr != epoch.data() + epoch.size()) {
+        return false;
+    }
+
+    value = static_cast<unsigned long long int>(number);
+    return true;
+}
+
+/**
+ * Parse epoch of EVR string with std::stoi rules: leading whitespace and sign are
+ * skipped, characters after the number are ignored. Epoch without leading number,
+ * out of int range or negative is invalid, std::stoi would throw for the first two.
+ * 
+ * @param epoch - epoch text, part of EVR before the colon
+ * @param value - parsed epoch, not changed if epoch is invalid
+ * @return Whether epoch is valid.
+ */
+inline bool parseEvrEpoch(std::string_view epoch, unsigned long long int& value) {
+    size_t pos = 0;
+    while (pos < epoch.size() && std::isspace(static_cast<unsigned char>(epoch[pos]))) {
+        ++pos;
+    }
+
+    bool negative = pos < epoch.size() && epoch[pos] == '-';
+    if (pos < epoch.size() && (epoch[pos] == '-' || epoch[pos] == '+')) {
+        ++pos;
+    }
+    if (pos == epoch.size() || !isDigit(epoch[pos])) {
+        return false;
+    }
+
+    unsigned long long int number = 0;
+    auto [ptr, ec] = std::from_chars(epoch.data() + pos, epoch.data() + epoch.size(), number);
+    if (ec != std::errc() || number > static_cast<unsigned long long int>(std::numeric_limits<int>::max()) ||
+        (negative && number != 0)) {
+        return false;
+    }
+
+    value = number;
+    return true;
+}
+
+/**
+ * Check EVR for validity, rules are shared by BasicRpmEvr and BasicRpmEvrView.
+ * 
+ * @return Empty string if EVR is valid, description of invalidity otherwise.
+ */
+inline std::string checkEvr(std::string_view evr) {
+    if (std::count(evr.cbegin(), evr.cend(), ':') > 1) {
+        return "EVR must contain only one colon symbol!";
+    }
+
+    size_t colon = evr.find(':');
+    unsigned long long int epoch = 0;
+    if (colon != std::string_view::npos && !parseEvrEpoch(evr.substr(0, colon), epoch)) {
+        return "Epoch must be a positive number!";
+    }
+
+    if (std::count(evr.cbegin(), evr.cend(), '-') > 1) {
+        return "EVR must contain only one hyphen symbol!";
+    }
+
+    return "";
+}
+
+/**
+ * Get the next segment of the label.
+ * 
+ * @param label - label that is split into segments
+ * @param pos - position to start search from, moved past the returned segment
+ * @return Next segment or empty view if there are no segments left.
+ */
+inline std::string_view nextSegment(std::string_view label, size_t& pos) {
+    while (pos < label.size() && !isDigit(label[pos]) && !isAlpha(label[pos])) {
+        ++pos;
+    }
+
+    size_t start = pos;
+    if (pos < label.size() && isDigit(label[pos])) {
+        while (pos < label.size() && isDigit(label[pos])) {
+            ++pos;
+        }
+    } else {
+        while (pos < label.size() && isAlpha(label[pos])) {
+            ++pos;
+        }
+    }
+
+    return label.substr(start, pos - start);
+}
+
+/**
+ * Compare two segments: numeric segments are compared by value and are newer
+ * than alphabetic ones, alphabetic segments are compared with strcmp rules.
+ */
+inline int cmpSegments(std::string_view lhs, std::string_view rhs) {
+    long long int lhsNumber = 0;
+    long long int rhsNumber = 0;
+    bool lhsIsNumber = std::from_chars(lhs.data(), lhs.data() + lhs.size(), lhsNumber).ec == std::errc();
+    bool rhsIsNumber = std::from_chars(rhs.data(), rhs.data() + rhs.size(), rhsNumber).ec == std::errc();
+
+    if (lhsIsNumber && rhsIsNumber) { // compare as numeric
+        if (lhsNumber > rhsNumber) {
+            return 1;
+        } else if (lhsNumber < rhsNumber) {
+            return -1;
+        }
+        return 0;
+    } else if (!lhsIsNumber && !rhsIsNumber) { // compare as alphabetic
+        int result = lhs.compare(rhs);
+        return (result > 0) - (result < 0);
+    }
+
+    // numeric elements is newer than alphabetic
+    return lhsIsNumber ? 1 : -1;
+}
+
+/**
+ * Compare the labels with rpmvercmp algorithm.
+ * Segments are extracted on the fly, so nothing is allocated
+ * and comparison stops at the first differing segment.
+ */
+inline int cmpLabels(std::string_view lhs, std::string_view rhs) {
+    // check for tilde and caret
+    if (lhs.find('~') != std::string_view::npos) {
+        return -1;
+    } else if (rhs.find('~') != std::string_view::npos) {
+        return 1;
+    }
+
+    if (lhs.find('^') != std::string_view::npos) {
+        return 1;
+    } else if (rhs.find('^') != std::string_view::npos) {
+        return -1;
+    }
+
+    size_t lhsPos = 0;
+    size_t rhsPos = 0;
+    while (true) {
+        std::string_view lhsSegment = nextSegment(lhs, lhsPos);
+        std::string_view rhsSegment = nextSegment(rhs, rhsPos);
+
+        // if segments are equal then longer segment wins
+        if (lhsSegment.empty() || rhsSegment.empty()) {
+            return !lhsSegment.empty() - !rhsSegment.empty();
+        }
+
+        int segmentComparison = cmpSegments(lhsSegment, rhsSegment);
+        if (segmentComparison != 0) {
+            return segmentComparison;
+        }
+    }
+}
+
+/**
+ * Get the next token of the label for UpstreamPolicy: tilde, caret or segment,
+ * separators are skipped.
+ * 
+ * @param label - label that is split into tokens
+ * @param pos - position to start search from, moved past the returned token
+ * @return Next token or empty view if there are no tokens left.
+ */
+inline std::string_view nextUpstreamToken(std::string_view label, size_t& pos) {
+    auto isMarker = [](char c) { return c == '~' || c == '^'; };
+    while (pos < label.size() && !isDigit(label[pos]) && !isAlpha(label[pos]) && !isMarker(label[pos])) {
+        ++pos;
+    }
+
+    if (pos < label.size() && isMarker(label[pos])) {
+        return label.substr(pos++, 1);
+    }
+
+    return nextSegment(label, pos);
+}
+
+/**
+ * Compare two segments for UpstreamPolicy: numeric segments are newer than alphabetic ones,
+ * numbers are compared by length without leading zeros and then with strcmp,
+ * so numbers of any length are supported.
+ */
+inline int cmpUpstreamSegments(std::string_view lhs, std::string_view rhs) {
+    bool lhsIsNumber = isDigit(lhs.front());
+    bool rhsIsNumber = isDigit(rhs.front());
+    if (lhsIsNumber != rhsIsNumber) {
+        return lhsIsNumber ? 1 : -1;
+    }
+
+    if (lhsIsNumber) {
+        lhs.remove_prefix(std::min(lhs.find_first_not_of('0'), lhs.size()));
+        rhs.remove_prefix(std::min(rhs.find_first_not_of('0'), rhs.size()));
+        if (lhs.size() != rhs.size()) {
+            return lhs.size() > rhs.size() ? 1 : -1;
+        }
+    }
+
+    int result = lhs.compare(rhs);
+    return (result > 0) - (result < 0);
+}
+
+/**
+ * Compare the labels as documented for upstream RPM (RPM Versioning, Fedora Versioning Guidelines):
+ * labels are compared token by token, tilde is older than anything, even the end of the label,
+ * caret is newer than the end of the label, but older than any segment.
+ */
+inline int cmpUpstreamLabels(std::string_view lhs, std::string_view rhs) {
+    size_t lhsPos = 0;
+    size_t rhsPos = 0;
+    while (true) {
+        std::string_view lhsToken = nextUpstreamToken(lhs, lhsPos);
+        std::string_view rhsToken = nextUpstreamToken(rhs, rhsPos);
+
+        bool lhsTilde = lhsToken == "~";
+        bool rhsTilde = rhsToken == "~";
+        if (lhsTilde != rhsTilde) {
+            return lhsTilde ? -1 : 1;
+        }
+
+        bool lhsCaret = lhsToken == "^";
+        bool rhsCaret = rhsToken == "^";
+        if (lhsCaret != rhsCaret) {
+            if (lhsToken.empty() || rhsToken.empty()) {
+                return lhsToken.empty() ? -1 : 1;
+            }
+            return lhsCaret ? -1 : 1;
+        }
+
+        // if tokens are equal then longer label wins
+        if (lhsToken.empty() || rhsToken.empty()) {
+            return !lhsToken.empty() - !rhsToken.empty();
+        }
+
+        if (lhsTilde || lhsCaret) {
+            continue;
+        }
+
+        int segmentComparison = cmpUpstreamSegments(lhsToken, rhsToken);
+        if (segmentComparison != 0) {
+            return segmentComparison;
+        }
+    }
+}
+
+/**
+ * Split epoch out of EVR without validation.
+ * 
+ * @param evr - EVR to split
+ * @param epoch - parsed epoch, 0 if EVR has no epoch
+ * @return Position where version starts.
+ */
+inline size_t splitEpoch(std::string_view evr, unsigned long long int& epoch) {
+    epoch = 0;
+    size_t colon = evr.find(':');
+    if (colon == std::string_view::npos) {
+        return 0;
+    }
+
+    parseEvrEpoch(evr.substr(0, colon), epoch);
+    return colon + 1;
+}
+
+/**
+ * Split version and release out of EVR without validation.
+ * 
+ * @param evr - EVR to split
+ * @param versionStart - position where version starts, see splitEpoch
+ * @param parts - parts to store version and release views in
+ */
+inline void splitLabels(std::string_view evr, size_t versionStart, EvrParts& parts) {
+    // hyphen is searched from the start as RpmEvr always did: for epoch like "-0"
+    // version is the rest after colon and release is the rest after the hyphen
+    size_t hyphen = evr.find('-');
+    if (hyphen != std::string_view::npos) {
+        parts.version = evr.substr(versionStart, hyphen - versionStart);
+        parts.release = evr.substr(hyphen + 1);
+    } else {
+        parts.version = evr.substr(versionStart);
+        parts.release = {};
+    }
+}
+
+/**
+ * Split EVR into parts without validation.
+ */
+inline EvrParts splitEvr(std::string_view evr) {
+    EvrParts parts;
+    splitLabels(evr, splitEpoch(evr, parts.epoch), parts);
+    return parts;
+}
+
+/**
+ * Compare the EVRs with rpmevrcmp algorithm, labels are compared by the policy.
+ */
+template <typename Policy = DefaultPolicy>
+int cmpEvrs(const EvrParts& lhs, const EvrParts& rhs) {
+    if (lhs.epoch > rhs.epoch) {
+        return 1;
+    } else if (lhs.epoch < rhs.epoch) {
+        return -1;
+    }
+
+    int versionComparison = Policy::cmpLabels(lhs.version, rhs.version);
+    if (versionComparison != 0) {
+        return versionComparison;
+    }
+
+    return Policy::cmpLabels(lhs.release, rhs.release);
+}
+
+} // namespace detail
+
+template <typename Policy>
+class BasicRpmEvr;
+
+namespace detail {
+
+template <typename Policy>
+EvrParts rpmEvrParts(const BasicRpmEvr<Policy>& evr);
+
+} // namespace detail
+
+template <typename Policy>
+class BasicRpmVer {
 public:
-    
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    /**
+     * @throw invalid_argument if there is invalid version value
+     */
+    BasicRpmVer(const std::string& version);
+
     /**
+     * Version is stored in memory of the allocator, so std::pmr containers
+     * of RpmVer pass their memory resource to the elements.
+     * 
+     * @param version - any string that converts to std::string_view
+     * @param allocator - allocator of the version storage, e.g. memory resource
      * @throw invalid_argument if there is invalid version value
      */
-    RpmVer(const std::string& version);
+    template <typename String, typename = std::enable_if_t<std::is_convertible_v<const String&, std::string_view>>>
+    BasicRpmVer(const String& version, const allocator_type& allocator);
+    BasicRpmVer(const BasicRpmVer& other, const allocator_type& allocator);
+    BasicRpmVer(BasicRpmVer&& other, const allocator_type& allocator);
+
+    BasicRpmVer(const BasicRpmVer&) = default;
+    BasicRpmVer(BasicRpmVer&&) = default;
+    BasicRpmVer& operator=(const BasicRpmVer&) = default;
+    BasicRpmVer& operator=(BasicRpmVer&&) = default;
     
     /**
      * Check label (Version or Release tag) for validity.
@@ -54,29 +479,58 @@ public:
      * Split label into segments.
      */
     static const std::vector<std::string_view> segments(std::string_view label);
+
+    /**
+     * Split label into segments, vector is allocated from the memory resource.
+     */
+    static std::pmr::vector<std::string_view> segments(std::string_view label, std::pmr::memory_resource* resource);
     
     std::string version() const;
+    allocator_type get_allocator() const;
     
-    bool operator>(const RpmVer& other);
-    bool operator<(const RpmVer& other);
-    bool operator==(const RpmVer& other);
+    bool operator>(const BasicRpmVer& other);
+    bool operator<(const BasicRpmVer& other);
+    bool operator==(const BasicRpmVer& other);
     
-    bool operator>=(const RpmVer& other) = delete;
-    bool operator<=(const RpmVer& other) = delete;
+    bool operator>=(const BasicRpmVer& other) = delete;
+    bool operator<=(const BasicRpmVer& other) = delete;
 
 private:
-    int cmp_impl(const RpmVer& other);
+    static const std::string isValid_impl(std::string_view label);
+    int cmp_impl(const BasicRpmVer& other);
 
-    std::string m_version;
+    std::pmr::string m_version;
 };
 
-class RpmEvr {
+using RpmVer = BasicRpmVer<DefaultPolicy>;
+
+template <typename Policy>
+class BasicRpmEvr {
 public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    /**
+     * @throw invalid_argument if there is invalid evr value
+     */
+    BasicRpmEvr(const std::string& evr);
 
     /**
+     * Version and release are stored in memory of the allocator, so std::pmr
+     * containers of RpmEvr pass their memory resource to the elements.
+     * 
+     * @param evr - any string that converts to std::string_view
+     * @param allocator - allocator of the version and release storage, e.g. memory resource
      * @throw invalid_argument if there is invalid evr value
      */
-    RpmEvr(const std::string& evr);
+    template <typename String, typename = std::enable_if_t<std::is_convertible_v<const String&, std::string_view>>>
+    BasicRpmEvr(const String& evr, const allocator_type& allocator);
+    BasicRpmEvr(const BasicRpmEvr& other, const allocator_type& allocator);
+    BasicRpmEvr(BasicRpmEvr&& other, const allocator_type& allocator);
+
+    BasicRpmEvr(const BasicRpmEvr&) = default;
+    BasicRpmEvr(BasicRpmEvr&&) = default;
+    BasicRpmEvr& operator=(const BasicRpmEvr&) = default;
+    BasicRpmEvr& operator=(BasicRpmEvr&&) = default;
     
     /**
      * Check EVR for validity.
@@ -104,44 +558,230 @@ public:
     unsigned long long int epoch() const;
     std::string version() const;
     std::string release() const;
+    allocator_type get_allocator() const;
     
-    bool operator>(const RpmEvr& other);
-    bool operator<(const RpmEvr& other);
-    bool operator==(const RpmEvr& other);
+    bool operator>(const BasicRpmEvr& other);
+    bool operator<(const BasicRpmEvr& other);
+    bool operator==(const BasicRpmEvr& other);
     
-    bool operator>=(const RpmEvr& other) = delete;
-    bool operator<=(const RpmEvr& other) = delete;
+    bool operator>=(const BasicRpmEvr& other) = delete;
+    bool operator<=(const BasicRpmEvr& other) = delete;
 
 private:
-    int cmp_impl(const RpmEvr& other);
-    void parseEvr(const std::string& evr);
+    friend EvrParts detail::rpmEvrParts<Policy>(const BasicRpmEvr& evr);
+
+    static const std::string isValid_impl(std::string_view evr);
+    int cmp_impl(const BasicRpmEvr& other);
+    void parseEvr(std::string_view evr);
 
     unsigned long long int m_epoch = 0;
-    std::string m_version;
-    std::string m_release;
+    std::pmr::string m_version;
+    std::pmr::string m_release;
+};
+
+using RpmEvr = BasicRpmEvr<DefaultPolicy>;
+
+/**
+ * Non-owning EVR over a caller-owned buffer.
+ * 
+ * Nothing is copied: epoch, version and release are split out of the viewed
+ * string on demand, and comparison only goes as far as it has to - hyphen
+ * is not searched for when epochs differ, and release is not compared
+ * when epoch or version already decide the result.
+ * The viewed buffer must outlive the view.
+ */
+template <typename Policy>
+class BasicRpmEvrView {
+public:
+
+    /**
+     * @throw invalid_argument if there is invalid evr value
+     */
+    BasicRpmEvrView(std::string_view evr);
+
+    /**
+     * Check EVR for validity.
+     * 
+     * @param evr - evr that is checked for validity
+     * @return String which is empty in case when EVR is valid
+     * and non empty when EVR is invalid.
+     * If EVR is invalid, than returned sting contains description of invalidity.
+     */
+    static const std::string isValid(std::string_view evr);
+
+    /**
+     * Compare the EVR without copying them.
+     * 
+     * @param lhs - first EVR to compare
+     * @param rhs - second EVR to compare
+     * @return comparison result:
+     *   1  if lhs > rhs
+     *   0  if lhs == rhs
+     *  -1  if lhs < rhs
+     * @throw invalid_argument if there is invalid lhs or rhs value
+     */
+    static int cmp(std::string_view lhs, std::string_view rhs);
+
+    std::string_view evr() const;
+    unsigned long long int epoch() const;
+    std::string_view version() const;
+    std::string_view release() const;
+
+    bool operator>(const BasicRpmEvrView& other) const;
+    bool operator<(const BasicRpmEvrView& other) const;
+    bool operator==(const BasicRpmEvrView& other) const;
+
+    bool operator>=(const BasicRpmEvrView& other) const = delete;
+    bool operator<=(const BasicRpmEvrView& other) const = delete;
+
+private:
+    int cmp_impl(const BasicRpmEvrView& other) const;
+
+    std::string_view m_evr;
+};
+
+using RpmEvrView = BasicRpmEvrView<DefaultPolicy>;
+
+/**
+ * Order in which selection algorithms pick EVRs.
+ */
+enum class EvrOrder {
+    Newest,
+    Oldest
+};
+
+/**
+ * Get k newest EVRs of the range in one pass, newest first.
+ * Each EVR is validated and split once, selection keeps only k candidates
+ * in a heap, so it takes O(n log k) comparisons instead of full sort.
+ * Order of equal EVRs is unspecified.
+ * 
+ * @param evrs - range of RpmEvr, RpmEvrView, EvrParts or EVR strings
+ * @param k - number of EVRs to select
+ * @throw invalid_argument if there is invalid EVR string in the range
+ */
+template <typename Range>
+auto newest(const Range& evrs, size_t k);
+
+/**
+ * Get k oldest EVRs of the range in one pass, oldest first.
+ * 
+ * @see newest
+ */
+template <typename Range>
+auto oldest(const Range& evrs, size_t k);
+
+/**
+ * Find the newest EVR of the range.
+ * 
+ * @param evrs - range of RpmEvr, RpmEvrView, EvrParts or EVR strings
+ * @return Iterator to the first of the newest EVRs or end iterator if range is empty.
+ * @throw invalid_argument if there is invalid EVR string in the range
+ */
+template <typename Range>
+auto maxElement(const Range& evrs);
+
+/**
+ * Rearrange the range so that its n-th element is the one that would be there if range
+ * was sorted from the oldest to the newest, all elements before it are not newer
+ * and all elements after it are not older than n-th.
+ * Selection runs on pre-split parts and takes O(n) comparisons on average.
+ * 
+ * @param evrs - random access range of RpmEvr, RpmEvrView, EvrParts or EVR strings
+ * @param n - position of the element, counting from the oldest
+ * @throw out_of_range if n is not less than size of the range
+ * @throw invalid_argument if there is invalid EVR string in the range
+ */
+template <typename Range>
+void nthElement(Range& evrs, size_t n);
+
+/**
+ * Streaming selection of k newest (or oldest) EVRs from the input of unknown size.
+ * Memory is bounded by k: EVR that is not better than the worst of
+ * kept ones is rejected with one comparison. Kept EVRs are split once,
+ * heap compares their pre-split parts.
+ */
+template <typename Evr, EvrOrder Order = EvrOrder::Newest>
+class TopK {
+public:
+    explicit TopK(size_t k);
+
+    /**
+     * @throw invalid_argument if evr is invalid EVR string
+     */
+    void push(Evr evr);
+
+    size_t size() const;
+
+    /**
+     * Take selected EVRs, best first, and reset the accumulator.
+     */
+    std::vector<Evr> take();
+
+private:
+    using Candidate = std::pair<EvrParts, size_t>; // parts of kept EVR and its slot
+
+    static bool better(const Candidate& lhs, const Candidate& rhs);
+
+    size_t m_k;
+    std::deque<Evr> m_evrs; // kept EVRs, deque doesn't move them, so parts stay valid
+    std::vector<Candidate> m_heap; // front is the worst of kept EVRs
 };
 
+/* ====================================== POLICIES ===================================== */
+inline int DefaultPolicy::cmpLabels(std::string_view lhs, std::string_view rhs) {
+    return detail::cmpLabels(lhs, rhs);
+}
+
+inline int UpstreamPolicy::cmpLabels(std::string_view lhs, std::string_view rhs) {
+    return detail::cmpUpstreamLabels(lhs, rhs);
+}
+
 /* ======================================== VER ======================================== */
-RpmVer::RpmVer(const std::string& version) {
-    auto isValidCheckResult = rpmcmplib::RpmVer::isValid(version);
+template <typename Policy>
+BasicRpmVer<Policy>::BasicRpmVer(const std::string& version) : BasicRpmVer(version, allocator_type()) {
+}
+
+template <typename Policy>
+template <typename String, typename>
+BasicRpmVer<Policy>::BasicRpmVer(const String& version, const allocator_type& allocator) : m_version(allocator) {
+    std::string_view label = version;
+    auto isValidCheckResult = isValid_impl(label);
     if (!isValidCheckResult.empty()) {
         throw std::invalid_argument(isValidCheckResult);
     }
 
-    m_version = version;
+    m_version.assign(label);
+}
+
+template <typename Policy>
+BasicRpmVer<Policy>::BasicRpmVer(const BasicRpmVer& other, const allocator_type& allocator)
+    : m_version(other.m_version, allocator) {
+}
+
+template <typename Policy>
+BasicRpmVer<Policy>::BasicRpmVer(BasicRpmVer&& other, const allocator_type& allocator)
+    : m_version(std::move(other.m_version), allocator) {
+}
+
+template <typename Policy>
+const std::string BasicRpmVer<Policy>::isValid(const std::string &label) {
+    return isValid_impl(label);
 }
 
-const std::string RpmVer::isValid(const std::string &label) {
-    if (label.find("-") != std::string::npos) {
+template <typename Policy>
+const std::string BasicRpmVer<Policy>::isValid_impl(std::string_view label) {
+    if (label.find("-") != std::string_view::npos) {
         return "Label can't have hyphen symbol!";
     }
 
     return "";
 }
 
-int RpmVer::cmp(const std::string& lhs, const std::string& rhs) {
-    RpmVer lhsEvr = RpmVer(lhs);
-    RpmVer rhsEvr = RpmVer(rhs);
+template <typename Policy>
+int BasicRpmVer<Policy>::cmp(const std::string& lhs, const std::string& rhs) {
+    BasicRpmVer lhsEvr(lhs);
+    BasicRpmVer rhsEvr(rhs);
 
     if (lhsEvr < rhsEvr) {
         return -1;
@@ -152,164 +792,112 @@ int RpmVer::cmp(const std::string& lhs, const std::string& rhs) {
     return 1;
 }
 
-const std::vector<std::string_view> RpmVer::segments(std::string_view label) {
+template <typename Policy>
+const std::vector<std::string_view> BasicRpmVer<Policy>::segments(std::string_view label) {
     std::vector<std::string_view> segmentsVector;
-    std::string_view segment;
-    for(size_t i = 0; i < label.size(); ++i) {
-        if ( std::isdigit(label.at(i)) || std::isalpha(label.at(i)) ) {
-            if (segment.empty()) {
-                segment = label.substr(i, 1);
-            } else if ( (std::isdigit(label.at(i)) && std::isdigit(segment.back())) ||
-                        (std::isalpha(label.at(i)) && std::isalpha(segment.back())) ) {
-                segment = {segment.data(), segment.size() + 1};
-            } else {
-                segmentsVector.push_back(segment);
-                segment = label.substr(i, 1);
-            }
-        } else {
-            if (!segment.empty()) {
-                segmentsVector.push_back(segment);
-                segment = {"", 0};
-            }
-        }
+    size_t pos = 0;
+    for (auto segment = detail::nextSegment(label, pos); !segment.empty(); segment = detail::nextSegment(label, pos)) {
+        segmentsVector.push_back(segment);
     }
 
-    if (!segment.empty()) {
+    return segmentsVector;
+}
+
+template <typename Policy>
+std::pmr::vector<std::string_view> BasicRpmVer<Policy>::segments(std::string_view label,
+                                                                 std::pmr::memory_resource* resource) {
+    std::pmr::vector<std::string_view> segmentsVector(resource);
+    size_t pos = 0;
+    for (auto segment = detail::nextSegment(label, pos); !segment.empty(); segment = detail::nextSegment(label, pos)) {
         segmentsVector.push_back(segment);
     }
 
     return segmentsVector;
 }
 
-std::string RpmVer::version() const {
-    return m_version;
+template <typename Policy>
+std::string BasicRpmVer<Policy>::version() const {
+    return std::string(m_version);
+}
+
+template <typename Policy>
+typename BasicRpmVer<Policy>::allocator_type BasicRpmVer<Policy>::get_allocator() const {
+    return m_version.get_allocator();
 }
 
-bool RpmVer::operator>(const RpmVer& other) {
+template <typename Policy>
+bool BasicRpmVer<Policy>::operator>(const BasicRpmVer& other) {
     if (cmp_impl(other) == 1) {
         return true;
     }
     return false;
 }
 
-bool RpmVer::operator<(const RpmVer& other) {
+template <typename Policy>
+bool BasicRpmVer<Policy>::operator<(const BasicRpmVer& other) {
     if (cmp_impl(other) == -1) {
         return true;
     }
     return false;
 }
 
-bool RpmVer::operator==(const RpmVer& other) {
+template <typename Policy>
+bool BasicRpmVer<Policy>::operator==(const BasicRpmVer& other) {
     if (cmp_impl(other) == 0) {
         return true;
     }
     return false;
 }
 
-int RpmVer::cmp_impl(const RpmVer& other) {
-    // check for tilde and caret
-    if (utils::contains(version(), "~")) {
-        return -1;
-    } else if (utils::contains(other.version(), "~")) {
-        return 1;
-    }
-
-    if (utils::contains(version(), "^")) {
-        return 1;
-    } else if (utils::contains(other.version(), "^")) {
-        return -1;
-    }
-
-    // split into segments
-    auto lhsSegments = segments({version().c_str(), version().size()});
-    auto rhsSegments = segments({other.version().c_str(), other.version().size()});
-
-    // compare segments
-    size_t length = std::min(lhsSegments.size(), rhsSegments.size());
-    for (size_t i = 0; i < length; ++i) {
-        long long int lhsNumber = 0;
-        long long int rhsNumber = 0;
-        bool lhsIsNumber = true;
-        bool rhsIsNumber = true;
-
-        auto [lhsPtr, lhsEc] = std::from_chars(lhsSegments.at(i).data(),
-                                               lhsSegments.at(i).data() + lhsSegments.at(i).size(),
-                                               lhsNumber);
-        if (lhsEc != std::errc()) {
-            lhsIsNumber = false;
-        }
-
-        auto [rhsPtr, rhsEc] = std::from_chars(rhsSegments.at(i).data(),
-                                               rhsSegments.at(i).data() + rhsSegments.at(i).size(),
-                                               rhsNumber);
-        if (rhsEc != std::errc()) {
-            rhsIsNumber = false;
-        }
-
-        if (lhsIsNumber && rhsIsNumber) { // compare as numeric
-            if (lhsNumber > rhsNumber) {
-                return 1;
-            } else if (lhsNumber < rhsNumber) {
-                return -1;
-            }
-        } else if (!lhsIsNumber && !rhsIsNumber) { // compare as alphabetic
-            if (lhsSegments.at(i) != rhsSegments.at(i)) {
-                if (lhsSegments.at(i).compare(rhsSegments.at(i)) < 0) {
-                    return -1;
-                } else {
-                    return 1;
-                }
-            }
-        } else { // numeric elements is newer than alphabetic
-            if(lhsIsNumber) {
-                return 1;
-            } else if (rhsIsNumber) {
-                return -1;
-            }
-        }
-    }
-
-    // if segments are equal then longer segment wins
-    if(lhsSegments.size() == rhsSegments.size()) {
-        return 0;
-    } else if (lhsSegments.size() > rhsSegments.size()) {
-        return 1;
-    }
-
-    return -1;
+template <typename Policy>
+int BasicRpmVer<Policy>::cmp_impl(const BasicRpmVer& other) {
+    return Policy::cmpLabels(m_version, other.m_version);
 }
 
 /* ======================================== EVR ======================================== */
-RpmEvr::RpmEvr(const std::string& evr) {
-    auto isValidCheckResult = rpmcmplib::RpmEvr::isValid(evr);
+template <typename Policy>
+BasicRpmEvr<Policy>::BasicRpmEvr(const std::string& evr) : BasicRpmEvr(evr, allocator_type()) {
+}
+
+template <typename Policy>
+template <typename String, typename>
+BasicRpmEvr<Policy>::BasicRpmEvr(const String& evr, const allocator_type& allocator)
+    : m_version(allocator), m_release(allocator) {
+    std::string_view evrView = evr;
+    auto isValidCheckResult = isValid_impl(evrView);
     if (!isValidCheckResult.empty()) {
         throw std::invalid_argument(isValidCheckResult);
     }
 
-    parseEvr(evr);
+    parseEvr(evrView);
 }
 
-const std::string RpmEvr::isValid(const std::string& evr) {
-    if (std::count(evr.cbegin(), evr.cend(), ':') > 1) {
-        return "EVR must contain only one colon symbol!";
-    }
+template <typename Policy>
+BasicRpmEvr<Policy>::BasicRpmEvr(const BasicRpmEvr& other, const allocator_type& allocator)
+    : m_epoch(other.m_epoch), m_version(other.m_version, allocator), m_release(other.m_release, allocator) {
+}
 
-    if (utils::contains(evr, ":")) {
-        if (std::stoi(evr.substr(0, evr.find(':'))) < 0) {
-            return "Epoch must be a positive number!";
-        }
-    }
+template <typename Policy>
+BasicRpmEvr<Policy>::BasicRpmEvr(BasicRpmEvr&& other, const allocator_type& allocator)
+    : m_epoch(other.m_epoch),
+      m_version(std::move(other.m_version), allocator),
+      m_release(std::move(other.m_release), allocator) {
+}
 
-    if (std::count(evr.cbegin(), evr.cend(), '-') > 1) {
-        return "EVR must contain only one hyphen symbol!";
-    }
+template <typename Policy>
+const std::string BasicRpmEvr<Policy>::isValid(const std::string& evr) {
+    return isValid_impl(evr);
+}
 
-    return "";
+template <typename Policy>
+const std::string BasicRpmEvr<Policy>::isValid_impl(std::string_view evr) {
+    return detail::checkEvr(evr);
 }
 
-int RpmEvr::cmp(const std::string& lhs, const std::string& rhs) {
-    RpmEvr lhsEvr = RpmEvr(lhs);
-    RpmEvr rhsEvr = RpmEvr(rhs);
+template <typename Policy>
+int BasicRpmEvr<Policy>::cmp(const std::string& lhs, const std::string& rhs) {
+    BasicRpmEvr lhsEvr(lhs);
+    BasicRpmEvr rhsEvr(rhs);
 
     if (lhsEvr < rhsEvr) {
         return -1;
@@ -320,74 +908,445 @@ int RpmEvr::cmp(const std::string& lhs, const std::string& rhs) {
     return 1;
 }
 
-unsigned long long int RpmEvr::epoch() const {
+template <typename Policy>
+unsigned long long int BasicRpmEvr<Policy>::epoch() const {
     return m_epoch;
 }
 
-std::string RpmEvr::version() const {
-    return m_version;
+template <typename Policy>
+std::string BasicRpmEvr<Policy>::version() const {
+    return std::string(m_version);
+}
+
+template <typename Policy>
+std::string BasicRpmEvr<Policy>::release() const {
+    return std::string(m_release);
 }
 
-std::string RpmEvr::release() const {
-    return m_release;
+template <typename Policy>
+typename BasicRpmEvr<Policy>::allocator_type BasicRpmEvr<Policy>::get_allocator() const {
+    return m_version.get_allocator();
 }
 
-bool RpmEvr::operator>(const RpmEvr& other) {
+template <typename Policy>
+bool BasicRpmEvr<Policy>::operator>(const BasicRpmEvr& other) {
     if (cmp_impl(other) == 1) {
         return true;
     }
     return false;
 }
 
-bool RpmEvr::operator<(const RpmEvr& other) {
+template <typename Policy>
+bool BasicRpmEvr<Policy>::operator<(const BasicRpmEvr& other) {
     if (cmp_impl(other) == -1) {
         return true;
     }
     return false;
 }
 
-bool RpmEvr::operator==(const RpmEvr& other) {
+template <typename Policy>
+bool BasicRpmEvr<Policy>::operator==(const BasicRpmEvr& other) {
     if (cmp_impl(other) == 0) {
         return true;
     }
     return false;
 }
 
-int RpmEvr::cmp_impl(const RpmEvr& other) {
-    if (epoch() > other.epoch()) {
+template <typename Policy>
+int BasicRpmEvr<Policy>::cmp_impl(const BasicRpmEvr& other) {
+    return detail::cmpEvrs<Policy>(detail::rpmEvrParts(*this), detail::rpmEvrParts(other));
+}
+
+template <typename Policy>
+void BasicRpmEvr<Policy>::parseEvr(std::string_view evr) {
+    EvrParts parts = detail::splitEvr(evr);
+    m_epoch = parts.epoch;
+    m_version.assign(parts.version);
+    m_release.assign(parts.release);
+}
+
+/* ====================================== EVR VIEW ===================================== */
+template <typename Policy>
+BasicRpmEvrView<Policy>::BasicRpmEvrView(std::string_view evr) {
+    auto isValidCheckResult = isValid(evr);
+    if (!isValidCheckResult.empty()) {
+        throw std::invalid_argument(isValidCheckResult);
+    }
+
+    m_evr = evr;
+}
+
+template <typename Policy>
+const std::string BasicRpmEvrView<Policy>::isValid(std::string_view evr) {
+    return detail::checkEvr(evr);
+}
+
+template <typename Policy>
+int BasicRpmEvrView<Policy>::cmp(std::string_view lhs, std::string_view rhs) {
+    return BasicRpmEvrView(lhs).cmp_impl(BasicRpmEvrView(rhs));
+}
+
+template <typename Policy>
+std::string_view BasicRpmEvrView<Policy>::evr() const {
+    return m_evr;
+}
+
+template <typename Policy>
+unsigned long long int BasicRpmEvrView<Policy>::epoch() const {
+    unsigned long long int epochNumber = 0;
+    detail::splitEpoch(m_evr, epochNumber);
+    return epochNumber;
+}
+
+template <typename Policy>
+std::string_view BasicRpmEvrView<Policy>::version() const {
+    return detail::splitEvr(m_evr).version;
+}
+
+template <typename Policy>
+std::string_view BasicRpmEvrView<Policy>::release() const {
+    return detail::splitEvr(m_evr).release;
+}
+
+template <typename Policy>
+bool BasicRpmEvrView<Policy>::operator>(const BasicRpmEvrView& other) const {
+    return cmp_impl(other) == 1;
+}
+
+template <typename Policy>
+bool BasicRpmEvrView<Policy>::operator<(const BasicRpmEvrView& other) const {
+    return cmp_impl(other) == -1;
+}
+
+template <typename Policy>
+bool BasicRpmEvrView<Policy>::operator==(const BasicRpmEvrView& other) const {
+    return cmp_impl(other) == 0;
+}
+
+template <typename Policy>
+int BasicRpmEvrView<Policy>::cmp_impl(const BasicRpmEvrView& other) const {
+    // each side is split once: colon first, hyphen only when epochs are equal
+    EvrParts lhs;
+    EvrParts rhs;
+    size_t lhsVersionStart = detail::splitEpoch(m_evr, lhs.epoch);
+    size_t rhsVersionStart = detail::splitEpoch(other.m_evr, rhs.epoch);
+    if (lhs.epoch > rhs.epoch) {
         return 1;
-    } else if (epoch() < other.epoch()) {
+    } else if (lhs.epoch < rhs.epoch) {
         return -1;
     }
 
-    int versionComparison = RpmVer::cmp(version(), other.version());
-    if ( versionComparison != 0) {
+    detail::splitLabels(m_evr, lhsVersionStart, lhs);
+    detail::splitLabels(other.m_evr, rhsVersionStart, rhs);
+    int versionComparison = Policy::cmpLabels(lhs.version, rhs.version);
+    if (versionComparison != 0) {
         return versionComparison;
     }
 
-    int releaseComparison = RpmVer::cmp(release(), other.release());
-    if ( releaseComparison != 0) {
-        return releaseComparison;
+    return Policy::cmpLabels(lhs.release, rhs.release);
+}
+
+/* ===================================== EVR PARTS ===================================== */
+inline int EvrParts::cmp(const EvrParts& lhs, const EvrParts& rhs) {
+    return detail::cmpEvrs(lhs, rhs);
+}
+
+inline bool EvrParts::operator>(const EvrParts& other) const {
+    return detail::cmpEvrs(*this, other) == 1;
+}
+
+inline bool EvrParts::operator<(const EvrParts& other) const {
+    return detail::cmpEvrs(*this, other) == -1;
+}
+
+inline bool EvrParts::operator==(const EvrParts& other) const {
+    return detail::cmpEvrs(*this, other) == 0;
+}
+
+/* ===================================== SELECTION ===================================== */
+namespace detail {
+
+template <typename Policy>
+EvrParts rpmEvrParts(const BasicRpmEvr<Policy>& evr) {
+    return {evr.m_epoch, evr.m_version, evr.m_release};
+}
+
+/**
+ * Comparison policy of EVR type: policy of EVR objects, default one for parts and strings.
+ */
+template <typename Evr>
+struct EvrTraits {
+    using Policy = DefaultPolicy;
+    static constexpr bool isRpmEvr = false;
+    static constexpr bool isRpmEvrView = false;
+};
+
+template <typename P>
+struct EvrTraits<BasicRpmEvr<P>> {
+    using Policy = P;
+    static constexpr bool isRpmEvr = true;
+    static constexpr bool isRpmEvrView = false;
+};
+
+template <typename P>
+struct EvrTraits<BasicRpmEvrView<P>> {
+    using Policy = P;
+    static constexpr bool isRpmEvr = false;
+    static constexpr bool isRpmEvrView = true;
+};
+
+template <typename Evr>
+using EvrPolicy = typename EvrTraits<Evr>::Policy;
+
+/**
+ * Split EVR object or EVR string into parts, strings are not validated.
+ */
+template <typename Evr>
+EvrParts evrParts(const Evr& evr) {
+    if constexpr (std::is_same_v<Evr, EvrParts>) {
+        return evr;
+    } else if constexpr (EvrTraits<Evr>::isRpmEvr) {
+        return rpmEvrParts(evr);
+    } else if constexpr (EvrTraits<Evr>::isRpmEvrView) {
+        return splitEvr(evr.evr());
+    } else {
+        return splitEvr(std::string_view(evr));
+    }
+}
+
+/**
+ * @throw invalid_argument if evr is invalid EVR string, EVR objects are already valid
+ */
+template <typename Evr>
+void validateEvr(const Evr& evr) {
+    if constexpr (!std::is_same_v<Evr, EvrParts> && !EvrTraits<Evr>::isRpmEvr && !EvrTraits<Evr>::isRpmEvrView) {
+        auto isValidCheckResult = RpmEvrView::isValid(evr);
+        if (!isValidCheckResult.empty()) {
+            throw std::invalid_argument(isValidCheckResult);
+        }
+    }
+}
+
+/**
+ * Order of labels that agrees with policy comparison wherever it is antisymmetric.
+ * For policies with whole label markers: labels with tilde < labels without tilde
+ * and caret < labels with caret, labels with tilde (or caret) are ordered bytewise
+ * among themselves. Labels that are equal for policy are equal here too.
+ */
+template <typename Policy>
+int orderLabels(std::string_view lhs, std::string_view rhs) {
+    if constexpr (Policy::wholeLabelMarkers) {
+        auto rank = [](std::string_view label) {
+            if (label.find('~') != std::string_view::npos) {
+                return 0;
+            } else if (label.find('^') != std::string_view::npos) {
+                return 2;
+            }
+            return 1;
+        };
+
+        int lhsRank = rank(lhs);
+        int rhsRank = rank(rhs);
+        if (lhsRank != rhsRank) {
+            return lhsRank > rhsRank ? 1 : -1;
+        } else if (lhsRank != 1) {
+            int result = lhs.compare(rhs);
+            return (result > 0) - (result < 0);
+        }
     }
 
-    return 0;
+    return Policy::cmpLabels(lhs, rhs);
 }
 
-void RpmEvr::parseEvr(const std::string& evr) {
-    if (utils::contains(evr, ":")) {
-        m_epoch = std::stoul(evr.substr(0, evr.find(':')));
+/**
+ * Weak order of EVRs: rpmevrcmp order with labels ordered by orderLabels,
+ * EVRs that are equal for rpmevrcmp are equivalent here.
+ */
+template <typename Policy>
+int weakOrderEvrs(const EvrParts& lhs, const EvrParts& rhs) {
+    if (lhs.epoch != rhs.epoch) {
+        return lhs.epoch > rhs.epoch ? 1 : -1;
     }
 
-    if (utils::contains(evr, "-")) {
-        size_t versionStart = (evr.find(':') == evr.npos) ? 0 : evr.find(':') + 1;
-        size_t versionSize = evr.find('-') - versionStart;
-        m_version = evr.substr(versionStart, versionSize);
-        m_release = evr.substr(evr.find('-')+1, evr.size());
-    } else if (utils::contains(evr, ":")) {
-        m_version = evr.substr(evr.find(':')+1, evr.size());
+    int result = orderLabels<Policy>(lhs.version, rhs.version);
+    return result != 0 ? result : orderLabels<Policy>(lhs.release, rhs.release);
+}
+
+/**
+ * Total order of EVRs: weak order with ties broken bytewise,
+ * EVRs are equal only when epoch, version and release are the same.
+ */
+template <typename Policy>
+int orderEvrs(const EvrParts& lhs, const EvrParts& rhs) {
+    int result = weakOrderEvrs<Policy>(lhs, rhs);
+    if (result == 0) {
+        result = lhs.version.compare(rhs.version);
+    }
+    if (result == 0) {
+        result = lhs.release.compare(rhs.release);
+    }
+
+    return (result > 0) - (result < 0);
+}
+
+/**
+ * Selection order: cmpEvrs isn't antisymmetric for labels that both have tilde
+ * (or caret), so heaps compare with the total order of EVRs that agrees with it elsewhere.
+ */
+template <EvrOrder Order, typename Policy>
+bool better(const EvrParts& lhs, const EvrParts& rhs) {
+    if constexpr (Order == EvrOrder::Newest) {
+        return orderEvrs<Policy>(lhs, rhs) > 0;
     } else {
-        m_version = evr;
+        return orderEvrs<Policy>(lhs, rhs) < 0;
+    }
+}
+
+template <typename Range>
+using RangeValue = std::decay_t<decltype(*std::begin(std::declval<Range&>()))>;
+
+template <EvrOrder Order, typename Range>
+std::vector<RangeValue<Range>> selectTop(const Range& evrs, size_t k) {
+    using Policy = EvrPolicy<RangeValue<Range>>;
+    using Candidate = std::pair<EvrParts, const RangeValue<Range>*>;
+    auto worse = [](const Candidate& lhs, const Candidate& rhs) { return better<Order, Policy>(lhs.first, rhs.first); };
+
+    // heap front is the worst of kept candidates
+    std::vector<Candidate> heap;
+    for (const auto& evr : evrs) {
+        validateEvr(evr);
+        Candidate candidate = {evrParts(evr), &evr};
+        if (heap.size() < k) {
+            heap.push_back(candidate);
+            std::push_heap(heap.begin(), heap.end(), worse);
+        } else if (k > 0 && better<Order, Policy>(candidate.first, heap.front().first)) {
+            std::pop_heap(heap.begin(), heap.end(), worse);
+            heap.back() = candidate;
+            std::push_heap(heap.begin(), heap.end(), worse);
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), worse);
+
+    std::vector<RangeValue<Range>> selected;
+    selected.reserve(heap.size());
+    for (const auto& candidate : heap) {
+        selected.push_back(*candidate.second);
     }
+
+    return selected;
+}
+
+} // namespace detail
+
+template <typename Range>
+auto newest(const Range& evrs, size_t k) {
+    return detail::selectTop<EvrOrder::Newest>(evrs, k);
+}
+
+template <typename Range>
+auto oldest(const Range& evrs, size_t k) {
+    return detail::selectTop<EvrOrder::Oldest>(evrs, k);
+}
+
+template <typename Range>
+auto maxElement(const Range& evrs) {
+    using Policy = detail::EvrPolicy<detail::RangeValue<Range>>;
+    auto result = std::end(evrs);
+    EvrParts resultParts;
+    for (auto it = std::begin(evrs); it != std::end(evrs); ++it) {
+        detail::validateEvr(*it);
+        EvrParts parts = detail::evrParts(*it);
+        if (result == std::end(evrs) || detail::cmpEvrs<Policy>(parts, resultParts) > 0) {
+            result = it;
+            resultParts = parts;
+        }
+    }
+
+    return result;
+}
+
+template <typename Range>
+void nthElement(Range& evrs, size_t n) {
+    auto first = std::begin(evrs);
+    size_t size = static_cast<size_t>(std::distance(first, std::end(evrs)));
+    if (n >= size) {
+        throw std::out_of_range("Element position is out of range!");
+    }
+
+    // select on pre-split keys, then move elements to their places
+    std::vector<std::pair<EvrParts, size_t>> keys;
+    keys.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        detail::validateEvr(first[i]);
+        keys.emplace_back(detail::evrParts(first[i]), i);
+    }
+
+    // keys are ordered strictly, so nth_element is safe and takes O(n) on average
+    using Policy = detail::EvrPolicy<detail::RangeValue<Range>>;
+    std::nth_element(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(n), keys.end(),
+                     [](const auto& lhs, const auto& rhs) { return detail::orderEvrs<Policy>(lhs.first, rhs.first) < 0; });
+
+    std::vector<bool> placed(size, false);
+    for (size_t i = 0; i < size; ++i) {
+        if (placed[i] || keys[i].second == i) {
+            continue;
+        }
+
+        auto displaced = std::move(first[i]);
+        size_t j = i;
+        while (keys[j].second != i) {
+            first[j] = std::move(first[keys[j].second]);
+            placed[j] = true;
+            j = keys[j].second;
+        }
+        first[j] = std::move(displaced);
+        placed[j] = true;
+    }
+}
+
+template <typename Evr, EvrOrder Order>
+TopK<Evr, Order>::TopK(size_t k) : m_k(k) {
+}
+
+template <typename Evr, EvrOrder Order>
+void TopK<Evr, Order>::push(Evr evr) {
+    detail::validateEvr(evr);
+    if (m_heap.size() < m_k) {
+        m_evrs.push_back(std::move(evr));
+        m_heap.emplace_back(detail::evrParts(m_evrs.back()), m_evrs.size() - 1);
+        std::push_heap(m_heap.begin(), m_heap.end(), better);
+    } else if (m_k > 0 && detail::better<Order, detail::EvrPolicy<Evr>>(detail::evrParts(evr), m_heap.front().first)) {
+        // worst EVR is replaced in its slot, parts are split from the stored EVR
+        std::pop_heap(m_heap.begin(), m_heap.end(), better);
+        size_t slot = m_heap.back().second;
+        m_evrs[slot] = std::move(evr);
+        m_heap.back().first = detail::evrParts(m_evrs[slot]);
+        std::push_heap(m_heap.begin(), m_heap.end(), better);
+    }
+}
+
+template <typename Evr, EvrOrder Order>
+size_t TopK<Evr, Order>::size() const {
+    return m_heap.size();
+}
+
+template <typename Evr, EvrOrder Order>
+std::vector<Evr> TopK<Evr, Order>::take() {
+    std::sort_heap(m_heap.begin(), m_heap.end(), better);
+    std::vector<Evr> selected;
+    selected.reserve(m_heap.size());
+    for (const auto& candidate : m_heap) {
+        selected.push_back(std::move(m_evrs[candidate.second]));
+    }
+
+    m_heap.clear();
+    m_evrs.clear();
+    return selected;
+}
+
+template <typename Evr, EvrOrder Order>
+bool TopK<Evr, Order>::better(const Candidate& lhs, const Candidate& rhs) {
+    return detail::better<Order, detail::EvrPolicy<Evr>>(lhs.first, rhs.first);
 }
 
 }  //namespace rpmcmplib
\ No newline at end of file
@@ -0,0 +1,511 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <rpmcmp.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rpmcmplib {
+
+namespace detail {
+
+/**
+ * Sorted inserts and tombstones of one update (or of several merged updates).
+ * Runs are immutable once published, so readers can keep using them while
+ * newer runs are being merged.
+ */
+template <typename Evr>
+struct EvrRun {
+    std::vector<Evr> inserted;
+    std::vector<Evr> erased;
+
+    size_t size() const;
+};
+
+} // namespace detail
+
+/**
+ * Sorted multiset of EVRs for large collections that change in small batches.
+ *
+ * Each update sorts only its own inserts and deletes (on pre-split parts) into a new run,
+ * runs of similar size are merged like in LSM tree, so update cost is proportional
+ * to the update size (amortized O(d log n) for d changed EVRs), not to the collection size.
+ * Deleted EVRs are kept as tombstones until their run is merged with the run they cancel.
+ *
+ * Readers take snapshot without locks and never wait for the update in progress:
+ * update builds new runs aside and then publishes new snapshot with atomic pointer store.
+ * Reader marks itself in the readers counter of the current epoch while it takes a reference
+ * to the current snapshot. Update moves to the next epoch once readers of the previous one
+ * have left, and holder replaced in epoch e is freed when epoch e + 2 starts, so only holders
+ * that readers in the middle of snapshot() may still use are kept. Updates are serialized
+ * with each other.
+ *
+ * Collection order extends rpmevrcmp order of EVR policy to a total one: with
+ * DefaultPolicy labels with tilde (or caret) are ordered bytewise among themselves,
+ * see rpmvercmp algorithm in the README, and EVRs that are equal for rpmevrcmp
+ * (e.g. "1.0" and "1_0") are ordered bytewise too. Two EVRs are the same element of the collection
+ * when they have the same epoch, version and release.
+ *
+ * @tparam Evr - BasicRpmEvr, BasicRpmEvrView, EvrParts or EVR string
+ */
+template <typename Evr = RpmEvr>
+class EvrCollection {
+public:
+
+    /**
+     * Immutable state of the collection.
+     */
+    class Snapshot {
+    public:
+        size_t size() const;
+        bool empty() const;
+
+        /**
+         * Count EVRs that have the same epoch, version and release as evr.
+         *
+         * @throw invalid_argument if evr is invalid EVR string
+         */
+        size_t count(const Evr& evr) const;
+        bool contains(const Evr& evr) const;
+
+        /**
+         * Call f for each EVR from the oldest to the newest.
+         */
+        template <typename F>
+        void forEach(F&& f) const;
+
+        /**
+         * Get all EVRs from the oldest to the newest.
+         */
+        std::vector<Evr> evrs() const;
+
+        /**
+         * Get number of sorted runs that are not merged yet.
+         */
+        size_t runs() const;
+
+    private:
+        friend class EvrCollection;
+
+        using Run = detail::EvrRun<Evr>;
+
+        Snapshot() = default;
+
+        std::vector<std::shared_ptr<const Run>> m_runs; // from the oldest to the newest
+        size_t m_size = 0;
+    };
+
+    /**
+     * @param maxRuns - number of runs after which whole collection is compacted into one run
+     */
+    explicit EvrCollection(size_t maxRuns = 16);
+
+    EvrCollection(const EvrCollection&) = delete;
+    EvrCollection& operator=(const EvrCollection&) = delete;
+
+    /**
+     * Get the current state of the collection, never blocks.
+     */
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+    /**
+     * Delete EVRs and then insert EVRs.
+     * Each deleted EVR removes one EVR that was in the collection before the update,
+     * deleting EVR that is not in the collection is ignored.
+     *
+     * @param inserted - EVRs to insert
+     * @param erased - EVRs to delete
+     * @return Number of deleted EVRs.
+     * @throw invalid_argument if there is invalid EVR string in the update,
+     * collection is not changed in this case
+     */
+    size_t update(std::vector<Evr> inserted, std::vector<Evr> erased = {});
+
+    /**
+     * Merge all runs into one and drop tombstones.
+     */
+    void compact();
+
+    /**
+     * Get number of replaced snapshot holders that are not freed yet,
+     * because readers that started before the replacement may still use them.
+     */
+    size_t retainedHolders() const;
+
+private:
+    using Run = detail::EvrRun<Evr>;
+    using Runs = std::vector<std::shared_ptr<const Run>>;
+    using Holder = std::shared_ptr<const Snapshot>;
+
+    // both must be called with update mutex locked (publish also from constructor)
+    std::shared_ptr<const Snapshot> currentSnapshot() const;
+    void publish(Runs runs, size_t size);
+
+    size_t m_maxRuns;
+    mutable std::mutex m_updateMutex;
+    std::atomic<size_t> m_epoch = 0; // changed only by updates
+    mutable std::atomic<size_t> m_readers[2] = {0, 0}; // readers taking reference to the current snapshot, by epoch parity
+    std::atomic<const Holder*> m_current = nullptr;
+
+    // guarded by update mutex
+    std::unique_ptr<const Holder> m_holder; // current one
+    std::vector<std::pair<size_t, std::unique_ptr<const Holder>>> m_retired; // epoch of replacement and holder
+};
+
+/* ==================================== COLLECTION ORDER ================================ */
+namespace detail {
+
+template <typename Evr>
+bool orderedBefore(const Evr& lhs, const Evr& rhs) {
+    return orderEvrs<EvrPolicy<Evr>>(evrParts(lhs), evrParts(rhs)) < 0;
+}
+
+/**
+ * Sort EVRs comparing parts that are split once.
+ */
+template <typename Evr>
+std::vector<Evr> sortEvrs(std::vector<Evr> evrs) {
+    std::vector<std::pair<EvrParts, size_t>> keys;
+    keys.reserve(evrs.size());
+    for (size_t i = 0; i < evrs.size(); ++i) {
+        keys.emplace_back(evrParts(evrs[i]), i);
+    }
+
+    std::sort(keys.begin(), keys.end(),
+              [](const auto& lhs, const auto& rhs) { return orderEvrs<EvrPolicy<Evr>>(lhs.first, rhs.first) < 0; });
+
+    std::vector<Evr> sorted;
+    sorted.reserve(evrs.size());
+    for (const auto& key : keys) {
+        sorted.push_back(std::move(evrs[key.second]));
+    }
+
+    return sorted;
+}
+
+/* ======================================== RUNS ======================================== */
+template <typename Evr>
+size_t EvrRun<Evr>::size() const {
+    return inserted.size() + erased.size();
+}
+
+/**
+ * Count EVRs of the sorted range that are the same as parts.
+ */
+template <typename Evr>
+size_t countSame(const std::vector<Evr>& evrs, const EvrParts& parts) {
+    auto range = std::equal_range(evrs.begin(), evrs.end(), parts, [](const auto& lhs, const auto& rhs) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(lhs)>, EvrParts>) {
+            return orderEvrs<EvrPolicy<Evr>>(lhs, evrParts(rhs)) < 0;
+        } else {
+            return orderEvrs<EvrPolicy<Evr>>(evrParts(lhs), rhs) < 0;
+        }
+    });
+
+    return static_cast<size_t>(std::distance(range.first, range.second));
+}
+
+/**
+ * Merge older run with newer one: inserts and tombstones of the same EVR cancel each other.
+ */
+template <typename Evr>
+EvrRun<Evr> mergeRuns(const EvrRun<Evr>& older, const EvrRun<Evr>& newer) {
+    std::vector<Evr> inserted;
+    inserted.reserve(older.inserted.size() + newer.inserted.size());
+    std::merge(older.inserted.begin(), older.inserted.end(), newer.inserted.begin(), newer.inserted.end(),
+               std::back_inserter(inserted), orderedBefore<Evr>);
+
+    std::vector<Evr> erased;
+    erased.reserve(older.erased.size() + newer.erased.size());
+    std::merge(older.erased.begin(), older.erased.end(), newer.erased.begin(), newer.erased.end(),
+               std::back_inserter(erased), orderedBefore<Evr>);
+
+    EvrRun<Evr> merged;
+    merged.inserted.reserve(inserted.size());
+    auto tombstone = erased.begin();
+    for (auto& evr : inserted) {
+        while (tombstone != erased.end() && orderedBefore(*tombstone, evr)) {
+            merged.erased.push_back(std::move(*tombstone++));
+        }
+
+        if (tombstone != erased.end() && !orderedBefore(evr, *tombstone)) {
+            ++tombstone;
+        } else {
+            merged.inserted.push_back(std::move(evr));
+        }
+    }
+    std::move(tombstone, erased.end(), std::back_inserter(merged.erased));
+
+    return merged;
+}
+
+/**
+ * K-way merge of runs from the oldest to the newest: f is called for each group
+ * of the same EVRs, in collection order, with pointers to inserts of the group
+ * and to its tombstones, both from the oldest run to the newest.
+ */
+template <typename Evr, typename F>
+void mergeGroups(const std::vector<std::shared_ptr<const EvrRun<Evr>>>& runs, F&& f) {
+    struct Cursor {
+        typename std::vector<Evr>::const_iterator current;
+        typename std::vector<Evr>::const_iterator end;
+        bool tombstone;
+    };
+
+    std::vector<Cursor> cursors;
+    for (const auto& run : runs) {
+        cursors.push_back({run->inserted.begin(), run->inserted.end(), false});
+        cursors.push_back({run->erased.begin(), run->erased.end(), true});
+    }
+
+    // runs are few, so the smallest head is found by linear scan
+    std::vector<const Evr*> inserted;
+    std::vector<const Evr*> tombstones;
+    while (true) {
+        const Evr* smallest = nullptr;
+        for (const auto& cursor : cursors) {
+            if (cursor.current != cursor.end && (!smallest || orderedBefore(*cursor.current, *smallest))) {
+                smallest = &*cursor.current;
+            }
+        }
+        if (!smallest) {
+            break;
+        }
+
+        EvrParts parts = evrParts(*smallest);
+        inserted.clear();
+        tombstones.clear();
+        for (auto& cursor : cursors) {
+            while (cursor.current != cursor.end &&
+                   orderEvrs<EvrPolicy<Evr>>(evrParts(*cursor.current), parts) == 0) {
+                (cursor.tombstone ? tombstones : inserted).push_back(&*cursor.current);
+                ++cursor.current;
+            }
+        }
+
+        f(inserted, tombstones);
+    }
+}
+
+/**
+ * Merge runs from the oldest to the newest into one with single k-way merge,
+ * so each EVR that is kept is copied once. Same as merging runs pairwise:
+ * tombstones cancel the oldest inserts of the same EVR.
+ */
+template <typename Evr>
+EvrRun<Evr> mergeRuns(const std::vector<std::shared_ptr<const EvrRun<Evr>>>& runs) {
+    size_t insertedSize = 0;
+    for (const auto& run : runs) {
+        insertedSize += run->inserted.size();
+    }
+
+    EvrRun<Evr> merged;
+    merged.inserted.reserve(insertedSize);
+    mergeGroups(runs, [&merged](const std::vector<const Evr*>& inserted, const std::vector<const Evr*>& tombstones) {
+        size_t cancelled = std::min(inserted.size(), tombstones.size());
+        for (size_t i = cancelled; i < inserted.size(); ++i) {
+            merged.inserted.push_back(*inserted[i]);
+        }
+        for (size_t i = cancelled; i < tombstones.size(); ++i) {
+            merged.erased.push_back(*tombstones[i]);
+        }
+    });
+
+    return merged;
+}
+
+} // namespace detail
+
+/* ====================================== SNAPSHOT ====================================== */
+template <typename Evr>
+size_t EvrCollection<Evr>::Snapshot::size() const {
+    return m_size;
+}
+
+template <typename Evr>
+bool EvrCollection<Evr>::Snapshot::empty() const {
+    return m_size == 0;
+}
+
+template <typename Evr>
+size_t EvrCollection<Evr>::Snapshot::count(const Evr& evr) const {
+    detail::validateEvr(evr);
+    EvrParts parts = detail::evrParts(evr);
+
+    // tombstones only cancel inserts of older runs, so the sum is never negative
+    size_t inserted = 0;
+    size_t erased = 0;
+    for (const auto& run : m_runs) {
+        inserted += detail::countSame(run->inserted, parts);
+        erased += detail::countSame(run->erased, parts);
+    }
+
+    return inserted - erased;
+}
+
+template <typename Evr>
+bool EvrCollection<Evr>::Snapshot::contains(const Evr& evr) const {
+    return count(evr) > 0;
+}
+
+template <typename Evr>
+template <typename F>
+void EvrCollection<Evr>::Snapshot::forEach(F&& f) const {
+    // tombstones cancel the oldest inserts of the same EVR
+    detail::mergeGroups(m_runs, [&f](const std::vector<const Evr*>& inserted, const std::vector<const Evr*>& tombstones) {
+        for (size_t i = tombstones.size(); i < inserted.size(); ++i) {
+            f(*inserted[i]);
+        }
+    });
+}
+
+template <typename Evr>
+std::vector<Evr> EvrCollection<Evr>::Snapshot::evrs() const {
+    std::vector<Evr> result;
+    result.reserve(m_size);
+    forEach([&result](const Evr& evr) { result.push_back(evr); });
+    return result;
+}
+
+template <typename Evr>
+size_t EvrCollection<Evr>::Snapshot::runs() const {
+    return m_runs.size();
+}
+
+/* ===================================== COLLECTION ===================================== */
+template <typename Evr>
+EvrCollection<Evr>::EvrCollection(size_t maxRuns) : m_maxRuns(std::max<size_t>(maxRuns, 1)) {
+    static_assert(std::atomic<size_t>::is_always_lock_free && std::atomic<const Holder*>::is_always_lock_free);
+    publish({}, 0);
+}
+
+template <typename Evr>
+std::shared_ptr<const typename EvrCollection<Evr>::Snapshot> EvrCollection<Evr>::snapshot() const {
+    // register in the counter of the epoch that is still current after registration,
+    // holders that may be loaded then aren't freed until the counter is drained, see publish
+    size_t epoch = m_epoch.load();
+    m_readers[epoch % 2].fetch_add(1);
+    for (size_t current = m_epoch.load(); current != epoch; current = m_epoch.load()) {
+        m_readers[epoch % 2].fetch_sub(1);
+        epoch = current;
+        m_readers[epoch % 2].fetch_add(1);
+    }
+
+    std::shared_ptr<const Snapshot> result = *m_current.load();
+    m_readers[epoch % 2].fetch_sub(1);
+    return result;
+}
+
+template <typename Evr>
+std::shared_ptr<const typename EvrCollection<Evr>::Snapshot> EvrCollection<Evr>::currentSnapshot() const {
+    return *m_holder;
+}
+
+template <typename Evr>
+size_t EvrCollection<Evr>::update(std::vector<Evr> inserted, std::vector<Evr> erased) {
+    for (const auto& evr : inserted) {
+        detail::validateEvr(evr);
+    }
+    for (const auto& evr : erased) {
+        detail::validateEvr(evr);
+    }
+
+    std::lock_guard<std::mutex> lock(m_updateMutex);
+    auto current = currentSnapshot();
+
+    auto run = std::make_shared<Run>();
+    run->inserted = detail::sortEvrs(std::move(inserted));
+
+    // keep only as many tombstones of the same EVR as there are such EVRs in the collection
+    erased = detail::sortEvrs(std::move(erased));
+    for (auto first = erased.begin(); first != erased.end();) {
+        auto last = std::find_if(first, erased.end(),
+                                 [first](const Evr& evr) { return detail::orderedBefore(*first, evr); });
+        size_t available = current->count(*first);
+        for (auto it = first; it != last && available > 0; ++it, --available) {
+            run->erased.push_back(std::move(*it));
+        }
+        first = last;
+    }
+
+    if (run->size() == 0) {
+        return 0;
+    }
+    size_t erasedCount = run->erased.size();
+    size_t size = current->m_size + run->inserted.size() - erasedCount;
+
+    // merge runs while the newer one isn't much smaller than the older,
+    // so run sizes grow geometrically and each EVR is merged O(log n) times
+    Runs runs = current->m_runs;
+    std::shared_ptr<const Run> newest = std::move(run);
+    while (!runs.empty() && runs.back()->size() <= 2 * newest->size()) {
+        newest = std::make_shared<Run>(detail::mergeRuns(*runs.back(), *newest));
+        runs.pop_back();
+    }
+    runs.push_back(std::move(newest));
+
+    if (runs.size() > m_maxRuns) {
+        runs = {std::make_shared<const Run>(detail::mergeRuns(runs))};
+    }
+
+    publish(std::move(runs), size);
+    return erasedCount;
+}
+
+template <typename Evr>
+void EvrCollection<Evr>::compact() {
+    std::lock_guard<std::mutex> lock(m_updateMutex);
+    auto current = currentSnapshot();
+    if (current->m_runs.size() <= 1) {
+        return;
+    }
+
+    publish({std::make_shared<const Run>(detail::mergeRuns(current->m_runs))}, current->m_size);
+}
+
+template <typename Evr>
+size_t EvrCollection<Evr>::retainedHolders() const {
+    std::lock_guard<std::mutex> lock(m_updateMutex);
+    return m_retired.size();
+}
+
+template <typename Evr>
+void EvrCollection<Evr>::publish(Runs runs, size_t size) {
+    auto next = std::shared_ptr<Snapshot>(new Snapshot());
+    next->m_runs = std::move(runs);
+    next->m_size = size;
+    auto holder = std::make_unique<const Holder>(std::move(next));
+    m_current.store(holder.get());
+    if (m_holder) {
+        m_retired.emplace_back(m_epoch.load(), std::move(m_holder));
+    }
+    m_holder = std::move(holder);
+
+    // epoch e + 1 starts once readers registered in e - 1 (same parity) have left,
+    // readers registered after that see epoch e and retry, so when epoch e + 2 starts
+    // nobody who could load holder replaced in e is in snapshot() anymore;
+    // two steps are enough to free everything replaced so far
+    for (int step = 0; step < 2; ++step) {
+        size_t epoch = m_epoch.load();
+        if (m_readers[(epoch + 1) % 2].load() != 0) {
+            break;
+        }
+        m_epoch.store(epoch + 1);
+    }
+
+    size_t epoch = m_epoch.load();
+    auto freed = std::find_if(m_retired.begin(), m_retired.end(),
+                              [epoch](const auto& retired) { return retired.first + 2 > epoch; });
+    m_retired.erase(m_retired.begin(), freed);
+}
+
+} // namespace rpmcmplib
@@ -0,0 +1,678 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <rpmcmp.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef RPMCMP_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rpmcmplib::repodata {
+
+/**
+ * Package from repository metadata, all views point into the batch it belongs to.
+ */
+struct Package {
+    std::string_view name;
+    std::string_view arch;
+    EvrParts evr;
+};
+
+/**
+ * Packages read from repository metadata together with storage of their strings.
+ * Batch can be moved (e.g. to another thread) without invalidating its packages.
+ * Storage is allocated from the memory resource of the reader.
+ */
+class PackageBatch {
+public:
+    PackageBatch() = default;
+    explicit PackageBatch(std::pmr::memory_resource* resource);
+    PackageBatch(PackageBatch&&) = default;
+    PackageBatch& operator=(PackageBatch&& other);
+
+    PackageBatch(const PackageBatch&) = delete;
+    PackageBatch& operator=(const PackageBatch&) = delete;
+
+    const std::pmr::vector<Package>& packages() const;
+    size_t size() const;
+    bool empty() const;
+
+private:
+    friend class PrimaryReader;
+
+    std::pmr::vector<char> m_arena;
+    std::pmr::vector<Package> m_packages;
+};
+
+using BatchConsumer = std::function<void(PackageBatch&& batch)>;
+
+/**
+ * Stream of bytes, e.g. file or decompressor on top of another source.
+ */
+class Source {
+public:
+    virtual ~Source() = default;
+
+    /**
+     * Read next bytes of the stream.
+     *
+     * @return Number of bytes read, 0 at the end of the stream.
+     * @throw runtime_error if stream can't be read
+     */
+    virtual size_t read(char* buffer, size_t size) = 0;
+};
+
+class FileSource : public Source {
+public:
+
+    /**
+     * @throw runtime_error if file can't be opened
+     */
+    explicit FileSource(const std::string& path);
+    ~FileSource() override;
+
+    FileSource(const FileSource&) = delete;
+    FileSource& operator=(const FileSource&) = delete;
+
+    size_t read(char* buffer, size_t size) override;
+
+private:
+    std::FILE* m_file;
+};
+
+#ifdef RPMCMP_WITH_ZLIB
+/**
+ * Decompresses gzip (or zlib) stream read from another source.
+ */
+class GzipSource : public Source {
+public:
+    explicit GzipSource(Source& compressed);
+    ~GzipSource() override;
+
+    GzipSource(const GzipSource&) = delete;
+    GzipSource& operator=(const GzipSource&) = delete;
+
+    size_t read(char* buffer, size_t size) override;
+
+private:
+    Source& m_compressed;
+    z_stream m_stream{};
+    std::vector<char> m_input = std::vector<char>(64 * 1024);
+    bool m_inputEnd = false;
+    bool m_inMember = false;
+};
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * Read-only memory mapping of the whole file.
+ */
+class MappedFile {
+public:
+
+    /**
+     * @throw runtime_error if file can't be mapped
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view content() const;
+
+private:
+    void* m_data = nullptr;
+    size_t m_size = 0;
+};
+#endif
+
+/**
+ * Streaming reader of repodata primary.xml.
+ *
+ * Only name, arch and version element of each package are extracted: name and arch
+ * text, version `epoch`, `ver` and `rel` attributes go straight to the batch storage
+ * and epoch is parsed to number, so EVR is never joined into `E:V-R` string.
+ * Streamed input is buffered up to the end of the last complete package element,
+ * so memory is bounded by read chunk, the biggest package element and batch size.
+ */
+class PrimaryReader {
+public:
+
+    /**
+     * @param resource - memory resource of batches, e.g. std::pmr::monotonic_buffer_resource
+     * that is released after the whole document is processed; batches consumed
+     * on worker threads are freed there, so the resource must be thread safe then
+     */
+    explicit PrimaryReader(size_t batchSize = 4096, size_t chunkSize = 1024 * 1024,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * Read packages from the whole document in memory (e.g. MappedFile content).
+     *
+     * @return Number of read packages.
+     * @throw invalid_argument if document has invalid package element
+     */
+    size_t read(std::string_view content, const BatchConsumer& consumer);
+
+    /**
+     * Read packages from the stream, batches are consumed on the calling thread.
+     *
+     * @return Number of read packages.
+     * @throw invalid_argument if document has invalid package element
+     * @throw runtime_error if source can't be read
+     */
+    size_t read(Source& source, const BatchConsumer& consumer);
+
+    /**
+     * Read packages from the stream, batches are consumed on worker threads
+     * while the next ones are read. Consumer must be thread safe.
+     * At most two batches per worker are waiting for consumption.
+     *
+     * @see read(Source&, const BatchConsumer&)
+     */
+    size_t read(Source& source, size_t workers, const BatchConsumer& consumer);
+
+private:
+    struct Span {
+        size_t offset = 0;
+        size_t size = 0;
+    };
+
+    struct PendingPackage {
+        Span name;
+        Span arch;
+        unsigned long long int epoch = 0;
+        Span version;
+        Span release;
+    };
+
+    size_t parse(std::string_view data, const BatchConsumer& consumer);
+    void reset();
+    void parsePackage(std::string_view element);
+    Span store(std::string_view raw);
+    void flush(const BatchConsumer& consumer);
+
+    size_t m_batchSize;
+    size_t m_chunkSize;
+    size_t m_count = 0;
+    std::pmr::memory_resource* m_resource;
+    std::pmr::vector<char> m_arena;
+    std::vector<PendingPackage> m_pending;
+};
+
+/* ==================================== PACKAGE BATCH =================================== */
+inline PackageBatch::PackageBatch(std::pmr::memory_resource* resource) : m_arena(resource), m_packages(resource) {
+}
+
+inline PackageBatch& PackageBatch::operator=(PackageBatch&& other) {
+    // assignment keeps the memory resource of this batch, containers with different
+    // memory resources copy elements instead of taking the buffer, so views of
+    // packages have to be moved to the new arena; move construction doesn't copy
+    const char* otherArena = other.m_arena.data();
+    m_arena = std::move(other.m_arena);
+    m_packages = std::move(other.m_packages);
+
+    const char* arena = m_arena.data();
+    if (arena != otherArena) {
+        auto rebase = [arena, otherArena](std::string_view view) {
+            return std::string_view(arena + (view.data() - otherArena), view.size());
+        };
+        for (auto& package : m_packages) {
+            package.name = rebase(package.name);
+            package.arch = rebase(package.arch);
+            package.evr.version = rebase(package.evr.version);
+            package.evr.release = rebase(package.evr.release);
+        }
+    }
+
+    return *this;
+}
+
+inline const std::pmr::vector<Package>& PackageBatch::packages() const {
+    return m_packages;
+}
+
+inline size_t PackageBatch::size() const {
+    return m_packages.size();
+}
+
+inline bool PackageBatch::empty() const {
+    return m_packages.empty();
+}
+
+/* ======================================= SOURCES ====================================== */
+inline FileSource::FileSource(const std::string& path) : m_file(std::fopen(path.c_str(), "rb")) {
+    if (m_file == nullptr) {
+        throw std::runtime_error("Can't open file " + path);
+    }
+}
+
+inline FileSource::~FileSource() {
+    std::fclose(m_file);
+}
+
+inline size_t FileSource::read(char* buffer, size_t size) {
+    size_t result = std::fread(buffer, 1, size, m_file);
+    if (result == 0 && std::ferror(m_file)) {
+        throw std::runtime_error("Can't read file!");
+    }
+
+    return result;
+}
+
+#ifdef RPMCMP_WITH_ZLIB
+inline GzipSource::GzipSource(Source& compressed) : m_compressed(compressed) {
+    // 32 - detect gzip or zlib header automatically
+    if (inflateInit2(&m_stream, 15 + 32) != Z_OK) {
+        throw std::runtime_error("Can't initialize zlib!");
+    }
+}
+
+inline GzipSource::~GzipSource() {
+    inflateEnd(&m_stream);
+}
+
+inline size_t GzipSource::read(char* buffer, size_t size) {
+    m_stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    m_stream.avail_out = static_cast<uInt>(size);
+
+    while (m_stream.avail_out == size) {
+        if (m_stream.avail_in == 0) {
+            if (m_inputEnd) {
+                break;
+            }
+
+            size_t received = m_compressed.read(m_input.data(), m_input.size());
+            m_inputEnd = (received == 0);
+            m_stream.next_in = reinterpret_cast<Bytef*>(m_input.data());
+            m_stream.avail_in = static_cast<uInt>(received);
+            if (m_inputEnd) {
+                if (m_inMember) {
+                    throw std::runtime_error("Truncated gzip stream!");
+                }
+                break;
+            }
+        }
+
+        int result = inflate(&m_stream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            // concatenated gzip members are one stream
+            inflateReset(&m_stream);
+            m_inMember = false;
+        } else if (result == Z_OK || result == Z_BUF_ERROR) {
+            m_inMember = true;
+        } else {
+            throw std::runtime_error("Corrupted gzip stream!");
+        }
+    }
+
+    return size - m_stream.avail_out;
+}
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+inline MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open file " + path);
+    }
+
+    struct stat fileStat {};
+    if (::fstat(fd, &fileStat) < 0) {
+        ::close(fd);
+        throw std::runtime_error("Can't stat file " + path);
+    }
+
+    m_size = static_cast<size_t>(fileStat.st_size);
+    if (m_size > 0) {
+        m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+
+    if (m_data == MAP_FAILED) {
+        m_data = nullptr;
+        throw std::runtime_error("Can't map file " + path);
+    }
+}
+
+inline MappedFile::~MappedFile() {
+    if (m_data != nullptr) {
+        ::munmap(m_data, m_size);
+    }
+}
+
+inline std::string_view MappedFile::content() const {
+    return {static_cast<const char*>(m_data), m_size};
+}
+#endif
+
+/* ==================================== PRIMARY READER ================================== */
+namespace detail {
+
+/**
+ * Get text of the first `<tag>text</tag>` element.
+ */
+inline std::string_view elementText(std::string_view element, std::string_view openTag, std::string_view closeTag) {
+    size_t begin = element.find(openTag);
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+
+    begin += openTag.size();
+    size_t end = element.find(closeTag, begin);
+    if (end == std::string_view::npos) {
+        return {};
+    }
+
+    return element.substr(begin, end - begin);
+}
+
+/**
+ * Get raw value of the tag attribute.
+ *
+ * @param tag - tag content between `<` and `>`
+ * @return Attribute value or nullptr view if there is no such attribute.
+ */
+inline std::string_view attribute(std::string_view tag, std::string_view name) {
+    size_t pos = tag.find_first_of(" \t\r\n");
+    while (pos < tag.size()) {
+        size_t nameBegin = tag.find_first_not_of(" \t\r\n", pos);
+        size_t equals = tag.find('=', nameBegin);
+        if (nameBegin == std::string_view::npos || equals == std::string_view::npos || equals + 1 >= tag.size()) {
+            break;
+        }
+
+        char quote = tag[equals + 1];
+        size_t valueEnd = tag.find(quote, equals + 2);
+        if ((quote != '"' && quote != '\'') || valueEnd == std::string_view::npos) {
+            break;
+        }
+
+        size_t nameEnd = tag.find_last_not_of(" \t\r\n", equals - 1) + 1;
+        if (tag.substr(nameBegin, nameEnd - nameBegin) == name) {
+            return tag.substr(equals + 2, valueEnd - equals - 2);
+        }
+        pos = valueEnd + 1;
+    }
+
+    return {};
+}
+
+} // namespace detail
+
+inline PrimaryReader::PrimaryReader(size_t batchSize, size_t chunkSize, std::pmr::memory_resource* resource)
+    : m_batchSize(std::max<size_t>(1, batchSize)),
+      m_chunkSize(std::max<size_t>(1, chunkSize)),
+      m_resource(resource),
+      m_arena(resource) {
+}
+
+inline size_t PrimaryReader::read(std::string_view content, const BatchConsumer& consumer) {
+    reset();
+    size_t consumed = parse(content, consumer);
+    if (content.find("<package", consumed) != std::string_view::npos) {
+        throw std::invalid_argument("Unterminated package element!");
+    }
+
+    flush(consumer);
+    return m_count;
+}
+
+inline size_t PrimaryReader::read(Source& source, const BatchConsumer& consumer) {
+    reset();
+    std::string buffer;
+    while (true) {
+        size_t size = buffer.size();
+        buffer.resize(size + m_chunkSize);
+        size_t received = source.read(buffer.data() + size, m_chunkSize);
+        buffer.resize(size + received);
+        if (received == 0) {
+            break;
+        }
+
+        buffer.erase(0, parse(buffer, consumer));
+    }
+
+    if (buffer.find("<package") != std::string::npos) {
+        throw std::invalid_argument("Unterminated package element!");
+    }
+
+    flush(consumer);
+    return m_count;
+}
+
+inline size_t PrimaryReader::read(Source& source, size_t workers, const BatchConsumer& consumer) {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<PackageBatch> queue;
+    std::exception_ptr consumerError;
+    bool finished = false;
+    size_t capacity = 2 * std::max<size_t>(1, workers);
+
+    auto work = [&] {
+        while (true) {
+            // batch is move-constructed, so it takes the arena of the queued one
+            // instead of copying it into the default resource
+            std::optional<PackageBatch> batch;
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [&] { return finished || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                batch.emplace(std::move(queue.front()));
+                queue.pop_front();
+            }
+            condition.notify_all();
+
+            try {
+                consumer(std::move(*batch));
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                if (!consumerError) {
+                    consumerError = std::current_exception();
+                }
+                finished = true;
+                queue.clear();
+                condition.notify_all();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < std::max<size_t>(1, workers); ++i) {
+        threads.emplace_back(work);
+    }
+
+    auto stop = [&] {
+        {
+            std::lock_guard lock(mutex);
+            finished = true;
+        }
+        condition.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    size_t count = 0;
+    try {
+        count = read(source, [&](PackageBatch&& batch) {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [&] { return finished || queue.size() < capacity; });
+            if (consumerError) {
+                std::rethrow_exception(consumerError);
+            }
+            queue.push_back(std::move(batch));
+            lock.unlock();
+            condition.notify_all();
+        });
+    } catch (...) {
+        stop();
+        throw;
+    }
+
+    stop();
+    if (consumerError) {
+        std::rethrow_exception(consumerError);
+    }
+
+    return count;
+}
+
+inline void PrimaryReader::reset() {
+    // packages of the previous read are left here if it has failed
+    m_count = 0;
+    m_pending.clear();
+    m_arena.clear();
+}
+
+inline size_t PrimaryReader::parse(std::string_view data, const BatchConsumer& consumer) {
+    constexpr std::string_view openTag = "<package";
+    constexpr std::string_view closeTag = "</package>";
+
+    size_t pos = 0;
+    while (true) {
+        size_t begin = data.find(openTag, pos);
+        if (begin == std::string_view::npos) {
+            // keep possibly cut open tag for the next chunk
+            return std::max(pos, data.size() - std::min(data.size(), openTag.size()));
+        }
+
+        // skip other elements with the same prefix, e.g. <packager>
+        size_t nameEnd = begin + openTag.size();
+        if (nameEnd == data.size()) {
+            return begin;
+        }
+        if (data[nameEnd] != '>' && data[nameEnd] != ' ' && data[nameEnd] != '\t' &&
+            data[nameEnd] != '\r' && data[nameEnd] != '\n') {
+            pos = nameEnd;
+            continue;
+        }
+
+        size_t end = data.find(closeTag, begin);
+        if (end == std::string_view::npos) {
+            return begin;
+        }
+
+        parsePackage(data.substr(begin, end - begin));
+        if (m_pending.size() >= m_batchSize) {
+            flush(consumer);
+        }
+        pos = end + closeTag.size();
+    }
+}
+
+inline void PrimaryReader::parsePackage(std::string_view element) {
+    std::string_view name = detail::elementText(element, "<name>", "</name>");
+    if (name.empty()) {
+        throw std::invalid_argument("Package without name!");
+    }
+
+    size_t versionBegin = element.find("<version ");
+    size_t versionEnd = element.find('>', versionBegin);
+    if (versionBegin == std::string_view::npos || versionEnd == std::string_view::npos) {
+        throw std::invalid_argument("Package " + std::string(name) + " without version!");
+    }
+    std::string_view versionTag = element.substr(versionBegin + 1, versionEnd - versionBegin - 1);
+
+    PendingPackage package;
+    std::string_view epoch = detail::attribute(versionTag, "epoch");
+    if (!epoch.empty() && !rpmcmplib::detail::parseEpoch(epoch, package.epoch)) {
+        throw std::invalid_argument("Package " + std::string(name) + ": Epoch must be a positive number!");
+    }
+
+    std::string_view version = detail::attribute(versionTag, "ver");
+    std::string_view release = detail::attribute(versionTag, "rel");
+    if (version.data() == nullptr) {
+        throw std::invalid_argument("Package " + std::string(name) + " without version!");
+    }
+    if (version.find('-') != std::string_view::npos || release.find('-') != std::string_view::npos) {
+        throw std::invalid_argument("Package " + std::string(name) + ": Label can't have hyphen symbol!");
+    }
+
+    package.name = store(name);
+    package.arch = store(detail::elementText(element, "<arch>", "</arch>"));
+    package.version = store(version);
+    package.release = store(release);
+    m_pending.push_back(package);
+}
+
+inline PrimaryReader::Span PrimaryReader::store(std::string_view raw) {
+    Span span = {m_arena.size(), 0};
+    size_t pos = 0;
+    while (pos < raw.size()) {
+        size_t entity = raw.find('&', pos);
+        m_arena.insert(m_arena.end(), raw.begin() + pos, raw.begin() + std::min(entity, raw.size()));
+        if (entity == std::string_view::npos) {
+            break;
+        }
+
+        // predefined XML entities, anything else is kept as is
+        static constexpr std::pair<std::string_view, char> entities[] = {
+            {"&lt;", '<'}, {"&gt;", '>'}, {"&amp;", '&'}, {"&quot;", '"'}, {"&apos;", '\''}
+        };
+        pos = entity + 1;
+        m_arena.push_back('&');
+        for (const auto& [reference, symbol] : entities) {
+            if (raw.substr(entity, reference.size()) == reference) {
+                m_arena.back() = symbol;
+                pos = entity + reference.size();
+                break;
+            }
+        }
+    }
+
+    span.size = m_arena.size() - span.offset;
+    return span;
+}
+
+inline void PrimaryReader::flush(const BatchConsumer& consumer) {
+    if (m_pending.empty()) {
+        return;
+    }
+
+    PackageBatch batch(m_resource);
+    batch.m_arena = std::move(m_arena);
+    batch.m_packages.reserve(m_pending.size());
+    const char* arena = batch.m_arena.data();
+    auto view = [arena](Span span) { return std::string_view(arena + span.offset, span.size); };
+    for (const auto& package : m_pending) {
+        batch.m_packages.push_back({view(package.name), view(package.arch),
+                                    {package.epoch, view(package.version), view(package.release)}});
+    }
+
+    m_count += m_pending.size();
+    m_arena = std::pmr::vector<char>(m_resource);
+    m_arena.reserve(batch.m_arena.capacity());
+    m_pending.clear();
+    consumer(std::move(batch));
+}
+
+} // namespace rpmcmplib::repodata
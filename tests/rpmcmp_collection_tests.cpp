@@ -0,0 +1,283 @@
+// SPDX-License-Identifier: MIT
+
+#include <rpmcmp_collection.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+
+using rpmcmplib::EvrCollection;
+using rpmcmplib::RpmEvr;
+
+namespace {
+
+std::vector<std::string> evrStrings(const EvrCollection<RpmEvr>::Snapshot& snapshot) {
+    std::vector<std::string> result;
+    snapshot.forEach([&result](const RpmEvr& evr) {
+        std::string release = evr.release().empty() ? "" : "-" + evr.release();
+        result.push_back(std::to_string(evr.epoch()) + ":" + evr.version() + release);
+    });
+    return result;
+}
+
+std::vector<RpmEvr> rpmEvrs(const std::vector<std::string>& evrs) {
+    return std::vector<RpmEvr>(evrs.begin(), evrs.end());
+}
+
+} // namespace
+
+TEST(RpmCmpCollection, UpdatesKeepCollectionSorted) {
+    // Arrange
+    EvrCollection<RpmEvr> collection;
+
+    // Act
+    collection.update(rpmEvrs({"1.10-1", "1:0.1-1", "1.2-1"}));
+    collection.update(rpmEvrs({"1.9-1", "1.2-1", "1.0~rc1-1"}));
+    auto snapshot = collection.snapshot();
+
+    // Assert
+    EXPECT_EQ(snapshot->size(), 6u);
+    EXPECT_EQ(evrStrings(*snapshot),
+              std::vector<std::string>({"0:1.0~rc1-1", "0:1.2-1", "0:1.2-1", "0:1.9-1", "0:1.10-1", "1:0.1-1"}));
+    EXPECT_EQ(snapshot->count(RpmEvr("1.2-1")), 2u);
+    EXPECT_EQ(snapshot->count(RpmEvr("0:1.2-1")), 2u);
+    EXPECT_FALSE(snapshot->contains(RpmEvr("1.2-2")));
+}
+
+TEST(RpmCmpCollection, EraseRemovesOnlyPresentEvrs) {
+    // Arrange
+    EvrCollection<std::string> collection;
+    collection.update({"1.0-1", "1.0-1", "2.0~rc1-1", "2.0~rc2-1", "3.0^git1-1"});
+
+    // Act
+    size_t erased = collection.update({"1.0-1"}, {"1.0-1", "1.0-1", "1.0-1", "2.0~rc2-1", "3.0^git1-1", "4.0-1"});
+    auto snapshot = collection.snapshot();
+
+    // Assert
+    EXPECT_EQ(erased, 4u);
+    EXPECT_EQ(snapshot->size(), 2u);
+    EXPECT_EQ(snapshot->evrs(), std::vector<std::string>({"2.0~rc1-1", "1.0-1"}));
+    EXPECT_TRUE(snapshot->contains("2.0~rc1-1"));
+    EXPECT_FALSE(snapshot->contains("2.0~rc2-1"));
+}
+
+TEST(RpmCmpCollection, InvalidUpdateDoesNotChangeCollection) {
+    // Arrange
+    EvrCollection<std::string> collection;
+    collection.update({"1.0-1"});
+    std::string result;
+
+    // Act
+    try {
+        collection.update({"2.0-1", "1.0-1-1"});
+    } catch(const std::exception& e) {
+        result = e.what();
+    }
+
+    // Assert
+    EXPECT_EQ(result, std::string("EVR must contain only one hyphen symbol!"));
+    EXPECT_EQ(collection.snapshot()->evrs(), std::vector<std::string>({"1.0-1"}));
+}
+
+TEST(RpmCmpCollection, SnapshotIsNotChangedByUpdates) {
+    // Arrange
+    EvrCollection<std::string> collection;
+    collection.update({"1.0", "2.0"});
+    auto before = collection.snapshot();
+
+    // Act
+    collection.update({"3.0"}, {"1.0"});
+    collection.compact();
+
+    // Assert
+    EXPECT_EQ(before->evrs(), std::vector<std::string>({"1.0", "2.0"}));
+    EXPECT_EQ(collection.snapshot()->evrs(), std::vector<std::string>({"2.0", "3.0"}));
+}
+
+TEST(RpmCmpCollection, OrderFollowsPolicyOfEvr) {
+    // Arrange
+    using UpstreamRpmEvr = rpmcmplib::BasicRpmEvr<rpmcmplib::UpstreamPolicy>;
+    EvrCollection<UpstreamRpmEvr> collection;
+    std::vector<std::string> versions;
+
+    // Act
+    collection.update({UpstreamRpmEvr("0.4.1.1"), UpstreamRpmEvr("0.4.1~rc2"), UpstreamRpmEvr("0.4.1^git1"),
+                       UpstreamRpmEvr("0.4.1~rc10"), UpstreamRpmEvr("0.4.1")});
+    collection.snapshot()->forEach([&versions](const UpstreamRpmEvr& evr) { versions.push_back(evr.version()); });
+
+    // Assert
+    EXPECT_EQ(versions, std::vector<std::string>({"0.4.1~rc2", "0.4.1~rc10", "0.4.1", "0.4.1^git1", "0.4.1.1"}));
+}
+
+TEST(RpmCmpCollection, RandomUpdatesMatchFullSort) {
+    // Arrange
+    std::mt19937 random(42);
+    EvrCollection<std::string> collection(4);
+    std::vector<std::string> expected;
+    auto randomEvr = [&random]() {
+        const char* suffixes[] = {"", "~rc1", "^git1", ".1", "a"};
+        return std::to_string(random() % 3) + ":" + std::to_string(random() % 20) + suffixes[random() % 5] +
+               "-" + std::to_string(random() % 3);
+    };
+    auto orderedBefore = [](const std::string& lhs, const std::string& rhs) {
+        return rpmcmplib::detail::orderEvrs<rpmcmplib::DefaultPolicy>(rpmcmplib::detail::splitEvr(lhs),
+                                                                   rpmcmplib::detail::splitEvr(rhs)) < 0;
+    };
+
+    for (int i = 0; i < 200; ++i) {
+        std::vector<std::string> inserted;
+        std::vector<std::string> erased;
+        for (size_t j = random() % 20; j > 0; --j) {
+            inserted.push_back(randomEvr());
+        }
+        for (size_t j = random() % 10; j > 0; --j) {
+            erased.push_back(randomEvr());
+        }
+
+        // Act
+        collection.update(inserted, erased);
+        for (const auto& evr : erased) {
+            auto found = std::find(expected.begin(), expected.end(), evr);
+            if (found != expected.end()) {
+                expected.erase(found);
+            }
+        }
+        expected.insert(expected.end(), inserted.begin(), inserted.end());
+        std::stable_sort(expected.begin(), expected.end(), orderedBefore);
+
+        // Assert
+        auto snapshot = collection.snapshot();
+        ASSERT_EQ(snapshot->evrs(), expected) << "update " << i;
+        ASSERT_EQ(snapshot->size(), expected.size()) << "update " << i;
+        ASSERT_LE(snapshot->runs(), 4u) << "update " << i;
+    }
+
+    collection.compact();
+    EXPECT_EQ(collection.snapshot()->runs(), 1u);
+    EXPECT_EQ(collection.snapshot()->evrs(), expected);
+}
+
+TEST(RpmCmpCollection, MergeOfManyRunsMatchesPairwiseMerges) {
+    // Arrange
+    using Run = rpmcmplib::detail::EvrRun<std::string>;
+    std::mt19937 random(7);
+    auto randomEvrs = [&random](size_t count) {
+        std::vector<std::string> evrs;
+        for (size_t i = 0; i < count; ++i) {
+            evrs.push_back("1." + std::to_string(random() % 8) + "-" + std::to_string(random() % 2));
+        }
+        return rpmcmplib::detail::sortEvrs(std::move(evrs));
+    };
+    std::vector<std::shared_ptr<const Run>> runs;
+    for (int i = 0; i < 6; ++i) {
+        runs.push_back(std::make_shared<const Run>(Run{randomEvrs(random() % 12), randomEvrs(random() % 6)}));
+    }
+    Run expected = *runs.front();
+    for (size_t i = 1; i < runs.size(); ++i) {
+        expected = rpmcmplib::detail::mergeRuns(expected, *runs[i]);
+    }
+
+    // Act
+    Run merged = rpmcmplib::detail::mergeRuns(runs);
+
+    // Assert
+    EXPECT_EQ(merged.inserted, expected.inserted);
+    EXPECT_EQ(merged.erased, expected.erased);
+}
+
+TEST(RpmCmpCollection, ReadersDuringUpdates) {
+    // Arrange
+    EvrCollection<std::string> collection;
+    std::atomic<bool> done = false;
+    std::atomic<size_t> unsortedSnapshots = 0;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                auto evrs = collection.snapshot()->evrs();
+                for (size_t j = 1; j < evrs.size(); ++j) {
+                    if (rpmcmplib::RpmEvr::cmp(evrs[j - 1], evrs[j]) > 0) {
+                        ++unsortedSnapshots;
+                    }
+                }
+            }
+        });
+    }
+
+    // Act
+    for (int i = 0; i < 300; ++i) {
+        collection.update({"1." + std::to_string(i), "2." + std::to_string(i)}, {"1." + std::to_string(i - 1)});
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    // Assert
+    EXPECT_EQ(unsortedSnapshots, 0u);
+    EXPECT_EQ(collection.snapshot()->size(), 301u);
+}
+
+TEST(RpmCmpCollection, SnapshotsTakenDuringUpdates) {
+    // Arrange
+    EvrCollection<std::string> collection;
+    std::atomic<bool> done = false;
+    std::atomic<size_t> shrunkSnapshots = 0;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            size_t size = 0;
+            while (!done) {
+                size_t nextSize = collection.snapshot()->size();
+                shrunkSnapshots += nextSize < size;
+                size = nextSize;
+            }
+        });
+    }
+
+    // Act
+    for (int i = 0; i < 2000; ++i) {
+        collection.update({"1." + std::to_string(i)});
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    // Assert
+    EXPECT_EQ(shrunkSnapshots, 0u);
+    EXPECT_EQ(collection.snapshot()->size(), 2000u);
+}
+
+TEST(RpmCmpCollection, ReplacedHoldersFreedWhileReadersActive) {
+    // Arrange
+    EvrCollection<std::string> collection;
+    std::atomic<bool> done = false;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 8; ++i) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                collection.snapshot();
+            }
+        });
+    }
+    size_t maxRetained = 0;
+
+    // Act
+    for (int i = 0; i < 20000; ++i) {
+        collection.update({"1." + std::to_string(i % 100)}, {"1." + std::to_string((i + 50) % 100)});
+        maxRetained = std::max(maxRetained, collection.retainedHolders());
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    collection.update({"2.0"});
+
+    // Assert
+    // reader preempted inside snapshot() holds back only holders replaced while it is there
+    EXPECT_LT(maxRetained, 2000u);
+    EXPECT_EQ(collection.retainedHolders(), 0u) << "nothing is kept once readers are gone";
+}
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: MIT
+
+#include <differential.hpp>
+
+#include <gtest/gtest.h>
+
+using namespace rpmcmplib;
+
+TEST(RpmCmpDifferential, RandomInputsMatchReference) {
+    // Arrange
+    const uint64_t seed = 1;
+
+    // Act
+    auto failure = fuzz::runRandom(seed, 2000);
+
+    // Assert
+    ASSERT_FALSE(failure) << fuzz::describe(*failure);
+}
+
+TEST(RpmCmpDifferential, KnownCornerCasesMatchReference) {
+    // Arrange
+    std::vector<std::vector<std::string>> cases = {
+        {"1.0", "1.0"},
+        {"1.0~rc1", "1.0"},
+        {"1.0^git1", "1.0"},
+        {"007", "7"},
+        {"99999999999999999999", "1"},
+        {"2147483648:1.0", "1.0"},
+        {" 1:1.0", "+1:1.0"},
+        {":1.0", "1a:1.0"},
+        {"99999999999:1.0", "2147483647:1.0"},
+        {"1:1.0-1", "1.0-1", "0:1.0-1"},
+        {"a", "1", "a1", "1a", ""},
+    };
+
+    for (const auto& inputs : cases) {
+        // Act
+        auto failure = fuzz::checkAll(inputs);
+
+        // Assert
+        EXPECT_FALSE(failure) << fuzz::describe(*failure);
+    }
+}
+
+TEST(RpmCmpDifferential, MinimizeShrinksFailingInputs) {
+    // Arrange
+    fuzz::Check containsX = [](const std::vector<std::string>& inputs) -> std::optional<fuzz::Failure> {
+        for (const auto& input : inputs) {
+            if (input.find('x') != std::string::npos) {
+                return fuzz::Failure{"x", inputs};
+            }
+        }
+        return std::nullopt;
+    };
+
+    // Act
+    auto failure = fuzz::minimize(fuzz::Failure{"x", {"1.0", "ab-x-cd", "2.0"}}, containsX);
+
+    // Assert
+    ASSERT_EQ(failure.inputs.size(), 1);
+    EXPECT_EQ(failure.inputs[0], "x");
+}
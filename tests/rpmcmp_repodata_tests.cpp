@@ -0,0 +1,368 @@
+// SPDX-License-Identifier: MIT
+
+#include <rpmcmp_repodata.hpp>
+
+#include "counting_resource.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory_resource>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace {
+
+const std::string primaryXml = R"(<?xml version="1.0" encoding="UTF-8"?>
+<metadata xmlns="http://linux.duke.edu/metadata/common" xmlns:rpm="http://linux.duke.edu/metadata/rpm" packages="3">
+<package type="rpm">
+  <name>bash</name>
+  <arch>x86_64</arch>
+  <version epoch="0" ver="5.2.15" rel="1.fc38"/>
+  <packager>Fedora Project</packager>
+  <format>
+    <rpm:provides>
+      <rpm:entry name="bash" flags="EQ" epoch="0" ver="5.2.15" rel="1.fc38"/>
+    </rpm:provides>
+  </format>
+</package>
+<package type="rpm">
+  <name>libstdc++</name>
+  <arch>i686</arch>
+  <version epoch="1" ver="13.0.1" rel="0.12.fc38"/>
+  <packager>Fedora Project</packager>
+</package>
+<package type="rpm">
+  <name>a&amp;b</name>
+  <arch>noarch</arch>
+  <version ver='1.0~rc1' rel='2'/>
+</package>
+</metadata>
+)";
+
+struct PackageCopy {
+    std::string name;
+    std::string arch;
+    unsigned long long epoch;
+    std::string version;
+    std::string release;
+
+    bool operator==(const PackageCopy& other) const {
+        return name == other.name && arch == other.arch && epoch == other.epoch &&
+               version == other.version && release == other.release;
+    }
+};
+
+const std::vector<PackageCopy> expectedPackages = {
+    {"bash", "x86_64", 0, "5.2.15", "1.fc38"},
+    {"libstdc++", "i686", 1, "13.0.1", "0.12.fc38"},
+    {"a&b", "noarch", 0, "1.0~rc1", "2"},
+};
+
+void collect(std::vector<PackageCopy>& packages, const rpmcmplib::repodata::PackageBatch& batch) {
+    for (const auto& package : batch.packages()) {
+        packages.push_back({std::string(package.name), std::string(package.arch), package.evr.epoch,
+                            std::string(package.evr.version), std::string(package.evr.release)});
+    }
+}
+
+/**
+ * Source returning data in small pieces to check elements cut between chunks.
+ */
+class StringSource : public rpmcmplib::repodata::Source {
+public:
+    StringSource(std::string data, size_t piece) : m_data(std::move(data)), m_piece(piece) {}
+
+    size_t read(char* buffer, size_t size) override {
+        size_t count = std::min({size, m_piece, m_data.size() - m_pos});
+        m_data.copy(buffer, count, m_pos);
+        m_pos += count;
+        return count;
+    }
+
+private:
+    std::string m_data;
+    size_t m_piece;
+    size_t m_pos = 0;
+};
+
+std::string tempPath(const std::string& name) {
+    return "/tmp/rpmcmp_repodata_tests_" + std::to_string(::getpid()) + "_" + name;
+}
+
+} // namespace
+
+TEST(RpmCmpRepodata, ReadFromMemory) {
+    // Arrange
+    rpmcmplib::repodata::PrimaryReader reader;
+    std::vector<PackageCopy> actualPackages;
+
+    // Act
+    size_t count = reader.read(std::string_view(primaryXml), [&](rpmcmplib::repodata::PackageBatch&& batch) {
+        collect(actualPackages, batch);
+    });
+
+    // Assert
+    EXPECT_EQ(count, 3u);
+    EXPECT_EQ(actualPackages, expectedPackages);
+}
+
+TEST(RpmCmpRepodata, ReadFromStreamInPieces) {
+    for (size_t piece : {1, 2, 7, 64, 4096}) {
+        for (size_t batchSize : {1, 2, 100}) {
+            // Arrange
+            StringSource source(primaryXml, piece);
+            rpmcmplib::repodata::PrimaryReader reader(batchSize, 5);
+            std::vector<PackageCopy> actualPackages;
+            size_t batches = 0;
+
+            // Act
+            size_t count = reader.read(source, [&](rpmcmplib::repodata::PackageBatch&& batch) {
+                collect(actualPackages, batch);
+                ++batches;
+            });
+
+            // Assert
+            EXPECT_EQ(count, 3u) << "piece = " << piece << ", batch = " << batchSize;
+            EXPECT_EQ(actualPackages, expectedPackages) << "piece = " << piece << ", batch = " << batchSize;
+            EXPECT_EQ(batches, (3 + batchSize - 1) / batchSize) << "piece = " << piece << ", batch = " << batchSize;
+        }
+    }
+}
+
+TEST(RpmCmpRepodata, ReadWithWorkers) {
+    // Arrange
+    std::ostringstream document;
+    document << "<metadata>\n";
+    for (int i = 0; i < 1000; ++i) {
+        document << "<package type=\"rpm\"><name>pkg" << i << "</name><arch>noarch</arch>"
+                 << "<version epoch=\"" << i % 3 << "\" ver=\"1." << i << "\" rel=\"1\"/></package>\n";
+    }
+    document << "</metadata>\n";
+    StringSource source(document.str(), 1000);
+    rpmcmplib::repodata::PrimaryReader reader(64, 4096);
+    std::atomic<size_t> consumed = 0;
+    std::mutex mutex;
+    std::vector<unsigned long long> newestEpochs;
+
+    // Act
+    size_t count = reader.read(source, 4, [&](rpmcmplib::repodata::PackageBatch&& batch) {
+        consumed += batch.size();
+        std::vector<rpmcmplib::EvrParts> evrs;
+        for (const auto& package : batch.packages()) {
+            evrs.push_back(package.evr);
+        }
+        auto batchNewest = rpmcmplib::newest(evrs, 1);
+        std::lock_guard lock(mutex);
+        newestEpochs.push_back(batchNewest.at(0).epoch);
+    });
+
+    // Assert
+    EXPECT_EQ(count, 1000u);
+    EXPECT_EQ(consumed, 1000u);
+    EXPECT_EQ(newestEpochs.size(), 16u);
+    for (auto epoch : newestEpochs) {
+        EXPECT_EQ(epoch, 2u);
+    }
+}
+
+TEST(RpmCmpRepodata, ConsumerErrorStopsReading) {
+    // Arrange
+    StringSource source(primaryXml, 16);
+    rpmcmplib::repodata::PrimaryReader reader(1);
+    std::string result;
+
+    // Act
+    try {
+        reader.read(source, 2, [](rpmcmplib::repodata::PackageBatch&&) {
+            throw std::runtime_error("Consumer failed!");
+        });
+    } catch(const std::exception& e) {
+        result = e.what();
+    }
+
+    // Assert
+    EXPECT_EQ(result, std::string("Consumer failed!"));
+}
+
+class RpmCmpRepodataInvalid : public ::testing::TestWithParam<std::tuple<std::string, std::string>> {};
+INSTANTIATE_TEST_SUITE_P(RpmCmpRepodataInvalidValues,
+                         RpmCmpRepodataInvalid,
+                         testing::Values(
+                            std::make_tuple("<package><name>a</name><version ver=\"1\" rel=\"1\"/>",
+                                            "Unterminated package element!"),
+                            std::make_tuple("<package><name>a</name></package>",
+                                            "Package a without version!"),
+                            std::make_tuple("<package><version ver=\"1\" rel=\"1\"/></package>",
+                                            "Package without name!"),
+                            std::make_tuple("<package><name>a</name><version epoch=\"1\" rel=\"1\"/></package>",
+                                            "Package a without version!"),
+                            std::make_tuple("<package><name>a</name><version epoch=\"-1\" ver=\"1\"/></package>",
+                                            "Package a: Epoch must be a positive number!"),
+                            std::make_tuple("<package><name>a</name><version epoch=\"99999999999\" ver=\"1\"/></package>",
+                                            "Package a: Epoch must be a positive number!"),
+                            std::make_tuple("<package><name>a</name><version epoch=\"2147483648\" ver=\"1\"/></package>",
+                                            "Package a: Epoch must be a positive number!"),
+                            std::make_tuple("<package><name>a</name><version ver=\"1-2\" rel=\"1\"/></package>",
+                                            "Package a: Label can't have hyphen symbol!")
+                         ));
+
+TEST_P(RpmCmpRepodataInvalid, RpmCmpRepodataInvalidCheck) {
+    // Arrange
+    auto [document, expectedResult] = GetParam();
+    rpmcmplib::repodata::PrimaryReader reader;
+    std::string actualResult;
+
+    // Act
+    try {
+        reader.read(std::string_view(document), [](rpmcmplib::repodata::PackageBatch&&) {});
+    } catch(const std::exception& e) {
+        actualResult = e.what();
+    }
+
+    // Assert
+    EXPECT_EQ(actualResult, expectedResult);
+}
+
+TEST(RpmCmpRepodata, ReadAfterFailedRead) {
+    // Arrange
+    rpmcmplib::repodata::PrimaryReader reader;
+    std::string failedDocument = "<package><name>stale</name><version ver=\"1\"/></package>"
+                                 "<package><name>broken</name></package>";
+    std::string document = "<package><name>fresh</name><version ver=\"1\"/></package>";
+    std::vector<PackageCopy> actualPackages;
+    EXPECT_THROW(reader.read(std::string_view(failedDocument), [](rpmcmplib::repodata::PackageBatch&&) {}),
+                 std::invalid_argument);
+
+    // Act
+    size_t count = reader.read(std::string_view(document), [&](rpmcmplib::repodata::PackageBatch&& batch) {
+        collect(actualPackages, batch);
+    });
+
+    // Assert
+    EXPECT_EQ(count, 1u);
+    EXPECT_EQ(actualPackages, std::vector<PackageCopy>({{"fresh", "", 0, "1", ""}}));
+}
+
+TEST(RpmCmpRepodata, ReadFileAndMappedFile) {
+    // Arrange
+    std::string path = tempPath("primary.xml");
+    std::ofstream(path) << primaryXml;
+    rpmcmplib::repodata::PrimaryReader reader;
+    std::vector<PackageCopy> filePackages;
+    std::vector<PackageCopy> mappedPackages;
+
+    // Act
+    rpmcmplib::repodata::FileSource file(path);
+    reader.read(file, [&](rpmcmplib::repodata::PackageBatch&& batch) {
+        collect(filePackages, batch);
+    });
+    rpmcmplib::repodata::MappedFile mapped(path);
+    reader.read(mapped.content(), [&](rpmcmplib::repodata::PackageBatch&& batch) {
+        collect(mappedPackages, batch);
+    });
+
+    // Assert
+    EXPECT_EQ(filePackages, expectedPackages);
+    EXPECT_EQ(mappedPackages, expectedPackages);
+    std::remove(path.c_str());
+}
+
+TEST(RpmCmpRepodata, PackagesCompareAsEvr) {
+    // Arrange
+    rpmcmplib::repodata::PrimaryReader reader;
+    std::vector<rpmcmplib::repodata::PackageBatch> batches;
+
+    // Act
+    reader.read(std::string_view(primaryXml), [&](rpmcmplib::repodata::PackageBatch&& batch) {
+        batches.push_back(std::move(batch));
+    });
+
+    // Assert
+    const auto& packages = batches.at(0).packages();
+    EXPECT_TRUE(packages[1].evr > packages[0].evr) << "1 epoch > 0 epoch";
+    EXPECT_TRUE(packages[2].evr < packages[0].evr) << "~ before version component means that version with it is earlier";
+    EXPECT_EQ(rpmcmplib::EvrParts::cmp(packages[0].evr, rpmcmplib::EvrParts{0, "5.2.15", "1.fc38"}), 0);
+}
+
+#ifdef RPMCMP_WITH_ZLIB
+TEST(RpmCmpRepodata, ReadGzip) {
+    // Arrange
+    std::string path = tempPath("primary.xml.gz");
+    gzFile gzip = gzopen(path.c_str(), "wb");
+    gzwrite(gzip, primaryXml.data(), static_cast<unsigned>(primaryXml.size()));
+    gzclose(gzip);
+    rpmcmplib::repodata::PrimaryReader reader(2, 16);
+    std::vector<PackageCopy> actualPackages;
+
+    // Act
+    rpmcmplib::repodata::FileSource file(path);
+    rpmcmplib::repodata::GzipSource source(file);
+    reader.read(source, [&](rpmcmplib::repodata::PackageBatch&& batch) {
+        collect(actualPackages, batch);
+    });
+
+    // Assert
+    EXPECT_EQ(actualPackages, expectedPackages);
+    std::remove(path.c_str());
+}
+#endif
+
+TEST(RpmCmpRepodata, BatchesFromMemoryResource) {
+    // Arrange
+    std::pmr::monotonic_buffer_resource arena;
+    rpmcmplib::repodata::PrimaryReader reader(2, 1024 * 1024, &arena);
+    std::vector<rpmcmplib::repodata::PackageBatch> batches;
+
+    // Act
+    reader.read(std::string_view(primaryXml), [&](rpmcmplib::repodata::PackageBatch&& batch) {
+        // move to batch with default resource: packages are copied out of the arena
+        rpmcmplib::repodata::PackageBatch kept;
+        kept = std::move(batch);
+        batches.push_back(std::move(kept));
+    });
+
+    // Assert
+    std::vector<PackageCopy> actualPackages;
+    for (const auto& batch : batches) {
+        EXPECT_EQ(batch.packages().get_allocator().resource(), std::pmr::get_default_resource());
+        collect(actualPackages, batch);
+    }
+    EXPECT_EQ(actualPackages, expectedPackages);
+}
+
+TEST(RpmCmpRepodata, WorkersKeepBatchesInReaderResource) {
+    // Arrange
+    std::ostringstream document;
+    document << "<metadata>\n";
+    for (int i = 0; i < 100; ++i) {
+        document << "<package type=\"rpm\"><name>pkg" << i << "</name><arch>noarch</arch>"
+                 << "<version ver=\"1." << i << "\" rel=\"1\"/></package>\n";
+    }
+    document << "</metadata>\n";
+    StringSource source(document.str(), 1000);
+    std::pmr::synchronized_pool_resource pool(std::pmr::new_delete_resource());
+    rpmcmplib::repodata::PrimaryReader reader(10, 4096, &pool);
+    rpmcmp_tests::CountingResource counting;
+    std::atomic<size_t> foreignBatches = 0;
+    std::atomic<size_t> consumed = 0;
+
+    // Act
+    std::pmr::memory_resource* previous = std::pmr::set_default_resource(&counting);
+    size_t count = reader.read(source, 4, [&](rpmcmplib::repodata::PackageBatch&& batch) {
+        if (batch.packages().get_allocator().resource() != &pool) {
+            ++foreignBatches;
+        }
+        consumed += batch.size();
+    });
+    std::pmr::set_default_resource(previous);
+
+    // Assert
+    EXPECT_EQ(count, 100u);
+    EXPECT_EQ(consumed, 100u);
+    EXPECT_EQ(foreignBatches, 0u);
+    EXPECT_EQ(counting.allocations, 0u) << "batches must not be copied into the default resource";
+}
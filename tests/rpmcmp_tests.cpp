@@ -2,8 +2,12 @@
 
 #include <rpmcmp.hpp>
 
+#include "counting_resource.hpp"
+
 #include <gtest/gtest.h>
 
+#include <memory_resource>
+
 /* ======================================== VER ======================================== */
 
 class RpmVerIsValid : public ::testing::TestWithParam<std::tuple<std::string, std::string>> {};
@@ -163,7 +167,15 @@ INSTANTIATE_TEST_SUITE_P(RpmEvrIsValidValues,
                             std::make_tuple("1:1.2.3-a:", "EVR must contain only one colon symbol!"),
                             std::make_tuple("1:1.2.3", ""),
                             std::make_tuple("0:1.2.3", ""),
-                            std::make_tuple("-1:1.2.3", "Epoch must be a positive number!")
+                            std::make_tuple("-1:1.2.3", "Epoch must be a positive number!"),
+                            std::make_tuple("a:1.2.3", "Epoch must be a positive number!"),
+                            std::make_tuple(":1.2.3", "Epoch must be a positive number!"),
+                            std::make_tuple(" 1:1.2.3", ""),
+                            std::make_tuple("+1:1.2.3", ""),
+                            std::make_tuple("1a:1.2.3", ""),
+                            std::make_tuple("2147483647:1.2.3", ""),
+                            std::make_tuple("2147483648:1.2.3", "Epoch must be a positive number!"),
+                            std::make_tuple("-0:1.2.3", "")
                          ));
 
 TEST_P(RpmEvrIsValid, RpmEvrIsValidCheck) {
@@ -284,7 +296,10 @@ INSTANTIATE_TEST_SUITE_P(RpmCmpEvrSplitValues,
                             std::make_tuple("999:1.2.3.4.5.6", 999, "1.2.3.4.5.6", ""),
                             std::make_tuple("009:1.2.3.4.5.6", 9, "1.2.3.4.5.6", ""),
                             std::make_tuple("1.2.3", 0, "1.2.3", ""),
-                            std::make_tuple("1.2.3.4.5.6", 0, "1.2.3.4.5.6", "")
+                            std::make_tuple("1.2.3.4.5.6", 0, "1.2.3.4.5.6", ""),
+                            std::make_tuple(" 1:1.2.3-1", 1, "1.2.3", "1"),
+                            std::make_tuple("+2:1.2.3", 2, "1.2.3", ""),
+                            std::make_tuple("3a:1.2.3", 3, "1.2.3", "")
                          ));
 
 TEST_P(RpmCmpEvrSplit, RpmCmpEvrSplitCheck) {
@@ -298,6 +313,7 @@ TEST_P(RpmCmpEvrSplit, RpmCmpEvrSplitCheck) {
     EXPECT_EQ(evr.epoch(), expectedEpoch);
     EXPECT_EQ(evr.version(), expectedVersion);
     EXPECT_EQ(evr.release(), expectedRelease);
+    EXPECT_EQ(rpmcmplib::RpmEvrView(evrValue).epoch(), expectedEpoch);
 }
 
 TEST(RpmCmp, RpmEvrCmpFuncLhsLowerRhs) {
@@ -441,3 +457,434 @@ TEST(RpmCmp, RpmEvrCmpObjLhsHigherRhs) {
     EXPECT_TRUE(rpmcmplib::RpmEvr("1.1")        > rpmcmplib::RpmEvr("1.1~201601")) << "~ before version component means that version with it is earlier than version without it";
     EXPECT_TRUE(rpmcmplib::RpmEvr("1.1^201601") > rpmcmplib::RpmEvr("1.1")) << "^ before version component means that version with it is later than version without it";
 }
+
+/* ====================================== EVR VIEW ===================================== */
+
+class RpmEvrViewIsValid : public ::testing::TestWithParam<std::tuple<std::string, std::string>> {};
+INSTANTIATE_TEST_SUITE_P(RpmEvrViewIsValidValues,
+                         RpmEvrViewIsValid,
+                         testing::Values(
+                            std::make_tuple("1.2.3-a", ""),
+                            std::make_tuple("1.2.3-a-", "EVR must contain only one hyphen symbol!"),
+                            std::make_tuple("1:1.2.3-a", ""),
+                            std::make_tuple("1:1.2.3-a:", "EVR must contain only one colon symbol!"),
+                            std::make_tuple("1:1.2.3", ""),
+                            std::make_tuple("0:1.2.3", ""),
+                            std::make_tuple("-1:1.2.3", "Epoch must be a positive number!"),
+                            std::make_tuple("a:1.2.3", "Epoch must be a positive number!"),
+                            std::make_tuple(":1.2.3", "Epoch must be a positive number!"),
+                            std::make_tuple(" 1:1.2.3", ""),
+                            std::make_tuple("+1:1.2.3", ""),
+                            std::make_tuple("1a:1.2.3", ""),
+                            std::make_tuple("2147483647:1.2.3", ""),
+                            std::make_tuple("2147483648:1.2.3", "Epoch must be a positive number!"),
+                            std::make_tuple("-0:1.2.3", "")
+                         ));
+
+TEST_P(RpmEvrViewIsValid, RpmEvrViewIsValidCheck) {
+    // Arrange
+    auto [version, expectedIsValidResult] = GetParam();
+
+    // Act
+    std::string actualIsValidResult = rpmcmplib::RpmEvrView::isValid(version);
+
+    // Assert
+    EXPECT_EQ(actualIsValidResult, expectedIsValidResult);
+}
+
+TEST(RpmCmp, EvrViewMustContainOnlyOneHyphenSymbolConstructor) {
+    // Arrange
+    std::string result;
+
+    // Act
+    try {
+        [[maybe_unused]] rpmcmplib::RpmEvrView evr = rpmcmplib::RpmEvrView("1.2.3-a-");
+    } catch(const std::exception& e) {
+        result = e.what();
+    }
+
+    // Assert
+    EXPECT_EQ(result, std::string("EVR must contain only one hyphen symbol!"));
+}
+
+class RpmCmpEvrViewSplit : public ::testing::TestWithParam<std::tuple<std::string, unsigned long long, std::string, std::string>> {};
+INSTANTIATE_TEST_SUITE_P(RpmCmpEvrViewSplitValues,
+                         RpmCmpEvrViewSplit,
+                         testing::Values(
+                            std::make_tuple("1:1.2.3-1", 1, "1.2.3", "1"),
+                            std::make_tuple("999:1.2.3.4.5.6-1", 999, "1.2.3.4.5.6", "1"),
+                            std::make_tuple("009:1.2.3.4.5.6-a.b.c.d.e.f", 9, "1.2.3.4.5.6", "a.b.c.d.e.f"),
+                            std::make_tuple("1:1.2.3", 1, "1.2.3", ""),
+                            std::make_tuple("009:1.2.3.4.5.6", 9, "1.2.3.4.5.6", ""),
+                            std::make_tuple("1.2.3", 0, "1.2.3", ""),
+                            std::make_tuple("1.2.3-4", 0, "1.2.3", "4")
+                         ));
+
+TEST_P(RpmCmpEvrViewSplit, RpmCmpEvrViewSplitCheck) {
+    // Arrange
+    auto [evrValue, expectedEpoch, expectedVersion, expectedRelease] = GetParam();
+
+    // Act
+    rpmcmplib::RpmEvrView evr = rpmcmplib::RpmEvrView(evrValue);
+
+    // Assert
+    EXPECT_EQ(evr.epoch(), expectedEpoch);
+    EXPECT_EQ(evr.version(), expectedVersion);
+    EXPECT_EQ(evr.release(), expectedRelease);
+    EXPECT_EQ(evr.evr(), evrValue);
+}
+
+TEST(RpmCmp, RpmEvrViewCmpMatchesRpmEvrCmp) {
+    // Arrange
+    std::vector<std::string> evrs = {
+        "0:1.2.3-1", "1:1.2.3-1", "1:foo.bar-1", "1:foo.bar", "3", "1:2", "888:1.2.3-1", "999:foo.bar-1",
+        "1.0", "1.1", "1.2.3", "1.0a", "1.0b", "2.5", "2.50", "1.9", "1.0010", "2.1.7A", "2.1.7a", "2a", "2.0",
+        "0.5.0.post1", "0.5.0.1", "0.5.1", "1", "1.1~201601", "1.1^201601", "3.0.0_fc", "3.0.0.fc",
+        "3.0.0_fc-3.0.0_fc", "3.0.0.fc-3.0.0.fc", "1.05-2", "1.5-10", "1.5-9"
+    };
+
+    // Act & Assert
+    for (const auto& lhs : evrs) {
+        for (const auto& rhs : evrs) {
+            EXPECT_EQ(rpmcmplib::RpmEvrView::cmp(lhs, rhs), rpmcmplib::RpmEvr::cmp(lhs, rhs)) << lhs << " VS " << rhs;
+        }
+    }
+}
+
+TEST(RpmCmp, RpmEvrViewCmpObj) {
+    // Arrange
+    std::string buffer = "1:2.0-1 1:2.0-2 2.0-1 1:2.0_1";
+    std::string_view view = buffer;
+
+    // Act
+    auto first = rpmcmplib::RpmEvrView(view.substr(0, 7));
+    auto second = rpmcmplib::RpmEvrView(view.substr(8, 7));
+    auto third = rpmcmplib::RpmEvrView(view.substr(16, 5));
+    auto fourth = rpmcmplib::RpmEvrView(view.substr(22, 7));
+
+    // Assert
+    EXPECT_TRUE(first < second) << "1 < 2 in release";
+    EXPECT_TRUE(second > first) << "2 > 1 in release";
+    EXPECT_TRUE(first > third) << "1 epoch > 0 epoch";
+    EXPECT_TRUE(fourth > first) << "version 2.0.1 has one more element than version 2.0";
+    EXPECT_TRUE(first == rpmcmplib::RpmEvrView("1:2.0-1"));
+}
+
+/* ====================================== POLICIES ===================================== */
+
+using UpstreamRpmVer = rpmcmplib::BasicRpmVer<rpmcmplib::UpstreamPolicy>;
+using UpstreamRpmEvr = rpmcmplib::BasicRpmEvr<rpmcmplib::UpstreamPolicy>;
+using UpstreamRpmEvrView = rpmcmplib::BasicRpmEvrView<rpmcmplib::UpstreamPolicy>;
+
+// published test vectors of upstream RPM and examples from Fedora Versioning Guidelines
+class RpmVerUpstreamCmp : public ::testing::TestWithParam<std::tuple<std::string, std::string, int>> {};
+INSTANTIATE_TEST_SUITE_P(RpmVerUpstreamCmpValues,
+                         RpmVerUpstreamCmp,
+                         testing::Values(
+                            std::make_tuple("1.0", "1.0", 0),
+                            std::make_tuple("1.0", "2.0", -1),
+                            std::make_tuple("2.0.1a", "2.0.1", 1),
+                            std::make_tuple("5.5p10", "5.5p1", 1),
+                            std::make_tuple("10xyz", "10.1xyz", -1),
+                            std::make_tuple("xyz.4", "8", -1),
+                            std::make_tuple("1.0aa", "1.0a", 1),
+                            std::make_tuple("10.0001", "10.1", 0),
+                            std::make_tuple("10.0001", "10.0039", -1),
+                            std::make_tuple("20101121", "20101122", -1),
+                            std::make_tuple("99999999999999999999", "1", 1),
+                            std::make_tuple("2.0", "2_0", 0),
+                            std::make_tuple("a+", "a_", 0),
+                            std::make_tuple("+_", "_+", 0),
+                            std::make_tuple("1.0~rc1", "1.0", -1),
+                            std::make_tuple("1.0~rc1", "1.0~rc2", -1),
+                            std::make_tuple("1.0~rc1~git123", "1.0~rc1", -1),
+                            std::make_tuple("1.0^", "1.0", 1),
+                            std::make_tuple("1.0^git1", "1.0^git2", -1),
+                            std::make_tuple("1.0^git1", "1.01", -1),
+                            std::make_tuple("1.0^20160101", "1.0.1", -1),
+                            std::make_tuple("1.0^20160101^git1", "1.0^20160101", 1),
+                            std::make_tuple("1.0~rc1^git1", "1.0~rc1", 1),
+                            std::make_tuple("1.0^git1~pre", "1.0^git1", -1),
+                            std::make_tuple("0.4.1^x", "0.4.1", 1),
+                            std::make_tuple("0.4.1^x", "0.4.2", -1),
+                            std::make_tuple("0.4.1^x", "0.4.1.y", -1),
+                            std::make_tuple("0.4.1~x", "0.4.1", -1),
+                            std::make_tuple("0.4.1~x", "0.4.0", 1)
+                         ));
+
+TEST_P(RpmVerUpstreamCmp, RpmVerUpstreamCmpCheck) {
+    // Arrange
+    auto [lhs, rhs, expectedResult] = GetParam();
+
+    // Act
+    int actualResult = UpstreamRpmVer::cmp(lhs, rhs);
+    int reversedResult = UpstreamRpmVer::cmp(rhs, lhs);
+
+    // Assert
+    EXPECT_EQ(actualResult, expectedResult);
+    EXPECT_EQ(reversedResult, -expectedResult);
+}
+
+TEST(RpmCmp, PoliciesDifferOnlyInLabelComparison) {
+    // Arrange
+    std::string tilde1 = "1:1.0~rc1-1";
+    std::string tilde2 = "1:1.0~rc2-1";
+    std::string caret = "1:0.4.1^git1-1";
+    std::string dot = "1:0.4.1.1-1";
+
+    // Act
+    int defaultTilde = rpmcmplib::RpmEvr::cmp(tilde2, tilde1);
+    int upstreamTilde = UpstreamRpmEvr::cmp(tilde2, tilde1);
+    int defaultCaret = rpmcmplib::RpmEvr::cmp(caret, dot);
+    int upstreamCaret = UpstreamRpmEvr::cmp(caret, dot);
+    int upstreamView = UpstreamRpmEvrView::cmp(caret, dot);
+
+    // Assert
+    EXPECT_EQ(defaultTilde, -1);
+    EXPECT_EQ(upstreamTilde, 1);
+    EXPECT_EQ(defaultCaret, 1);
+    EXPECT_EQ(upstreamCaret, -1);
+    EXPECT_EQ(upstreamView, -1);
+    EXPECT_EQ(UpstreamRpmEvr::isValid("1:1.0-1-1"), std::string("EVR must contain only one hyphen symbol!"));
+}
+
+TEST(RpmCmp, SelectionUsesPolicyOfEvr) {
+    // Arrange
+    std::vector<UpstreamRpmEvr> evrs = {UpstreamRpmEvr("1.0~rc2"), UpstreamRpmEvr("1.0~rc10"), UpstreamRpmEvr("1.0~rc1")};
+
+    // Act
+    auto selected = rpmcmplib::newest(evrs, 2);
+
+    // Assert
+    ASSERT_EQ(selected.size(), 2u);
+    EXPECT_EQ(selected[0].version(), "1.0~rc10");
+    EXPECT_EQ(selected[1].version(), "1.0~rc2");
+}
+
+/* ===================================== SELECTION ===================================== */
+
+TEST(RpmCmp, NewestOfStrings) {
+    // Arrange
+    std::vector<std::string> evrs = {"1.0-1", "1:0.1-1", "2.0-1", "1.0-10", "1.5-1", "1.0-2"};
+    std::vector<std::string> expectedNewest = {"1:0.1-1", "2.0-1", "1.5-1"};
+
+    // Act
+    auto actualNewest = rpmcmplib::newest(evrs, 3);
+
+    // Assert
+    EXPECT_EQ(actualNewest, expectedNewest);
+}
+
+TEST(RpmCmp, OldestOfEvrViews) {
+    // Arrange
+    std::vector<rpmcmplib::RpmEvrView> evrs = {
+        rpmcmplib::RpmEvrView("1.0-1"), rpmcmplib::RpmEvrView("1:0.1-1"), rpmcmplib::RpmEvrView("1.0-10"),
+        rpmcmplib::RpmEvrView("1.0-2")
+    };
+
+    // Act
+    auto actualOldest = rpmcmplib::oldest(evrs, 2);
+
+    // Assert
+    ASSERT_EQ(actualOldest.size(), 2u);
+    EXPECT_EQ(actualOldest[0].evr(), "1.0-1");
+    EXPECT_EQ(actualOldest[1].evr(), "1.0-2");
+}
+
+TEST(RpmCmp, NewestMoreThanRangeSize) {
+    // Arrange
+    std::vector<rpmcmplib::RpmEvr> evrs = {rpmcmplib::RpmEvr("1.0"), rpmcmplib::RpmEvr("3.0"), rpmcmplib::RpmEvr("2.0")};
+
+    // Act
+    auto actualNewest = rpmcmplib::newest(evrs, 10);
+    auto actualNone = rpmcmplib::newest(evrs, 0);
+
+    // Assert
+    ASSERT_EQ(actualNewest.size(), 3u);
+    EXPECT_EQ(actualNewest[0].version(), "3.0");
+    EXPECT_EQ(actualNewest[1].version(), "2.0");
+    EXPECT_EQ(actualNewest[2].version(), "1.0");
+    EXPECT_TRUE(actualNone.empty());
+}
+
+TEST(RpmCmp, NewestInvalidEvr) {
+    // Arrange
+    std::vector<std::string> evrs = {"1.0-1", "1.0-1-1"};
+    std::string result;
+
+    // Act
+    try {
+        rpmcmplib::newest(evrs, 1);
+    } catch(const std::exception& e) {
+        result = e.what();
+    }
+
+    // Assert
+    EXPECT_EQ(result, std::string("EVR must contain only one hyphen symbol!"));
+}
+
+TEST(RpmCmp, MaxElement) {
+    // Arrange
+    std::vector<std::string> evrs = {"1.0-1", "0:2.0-1", "1.9-1", "2.0-1"};
+    std::vector<std::string> empty;
+
+    // Act
+    auto actualMax = rpmcmplib::maxElement(evrs);
+
+    // Assert
+    EXPECT_EQ(actualMax - evrs.begin(), 1) << "the first of the newest EVRs";
+    EXPECT_EQ(rpmcmplib::maxElement(empty), empty.end());
+}
+
+TEST(RpmCmp, NthElement) {
+    for (size_t n = 0; n < 7; ++n) {
+        // Arrange
+        std::vector<std::string> evrs = {"5", "1", "1:0", "3", "1.5", "4", "2"};
+        std::vector<std::string> sorted = {"1", "1.5", "2", "3", "4", "5", "1:0"};
+
+        // Act
+        rpmcmplib::nthElement(evrs, n);
+
+        // Assert
+        EXPECT_EQ(evrs[n], sorted[n]) << "n = " << n;
+        for (size_t i = 0; i < evrs.size(); ++i) {
+            if (i < n) {
+                EXPECT_NE(rpmcmplib::RpmEvr::cmp(evrs[i], evrs[n]), 1) << "n = " << n << ", i = " << i;
+            } else if (i > n) {
+                EXPECT_NE(rpmcmplib::RpmEvr::cmp(evrs[i], evrs[n]), -1) << "n = " << n << ", i = " << i;
+            }
+        }
+        std::sort(evrs.begin(), evrs.end());
+        std::sort(sorted.begin(), sorted.end());
+        EXPECT_EQ(evrs, sorted) << "elements are only rearranged";
+    }
+}
+
+TEST(RpmCmp, NthElementWithMarkers) {
+    // Arrange
+    auto before = [](const std::string& lhs, const std::string& rhs) {
+        return rpmcmplib::detail::orderEvrs<rpmcmplib::DefaultPolicy>(rpmcmplib::detail::splitEvr(lhs),
+                                                                      rpmcmplib::detail::splitEvr(rhs)) < 0;
+    };
+    std::vector<std::string> original;
+    for (int i = 0; i < 200; ++i) {
+        const char* suffixes[] = {"~rc", "^git", ".", "_"};
+        original.push_back("1.0" + std::string(suffixes[(i * 7) % 4]) + std::to_string((i * 31) % 50));
+    }
+    std::vector<std::string> sorted = original;
+    std::sort(sorted.begin(), sorted.end(), before);
+
+    for (size_t n : {size_t(0), size_t(57), size_t(100), size_t(199)}) {
+        std::vector<std::string> evrs = original;
+
+        // Act
+        rpmcmplib::nthElement(evrs, n);
+
+        // Assert
+        EXPECT_EQ(evrs[n], sorted[n]) << "n = " << n;
+        for (size_t i = 0; i < evrs.size(); ++i) {
+            EXPECT_FALSE(i < n && before(evrs[n], evrs[i])) << "n = " << n << ", i = " << i;
+            EXPECT_FALSE(i > n && before(evrs[i], evrs[n])) << "n = " << n << ", i = " << i;
+        }
+    }
+}
+
+TEST(RpmCmp, NthElementOutOfRange) {
+    // Arrange
+    std::vector<std::string> evrs = {"1.0", "2.0"};
+
+    // Act & Assert
+    EXPECT_THROW(rpmcmplib::nthElement(evrs, 2), std::out_of_range);
+}
+
+TEST(RpmCmp, TopKStreaming) {
+    // Arrange
+    rpmcmplib::TopK<std::string> newestAccumulator(3);
+    rpmcmplib::TopK<std::string, rpmcmplib::EvrOrder::Oldest> oldestAccumulator(2);
+
+    // Act
+    for (int i = 0; i < 1000; ++i) {
+        std::string evr = "1." + std::to_string((i * 7919) % 1000) + "-1";
+        newestAccumulator.push(evr);
+        oldestAccumulator.push(evr);
+    }
+
+    // Assert
+    EXPECT_EQ(newestAccumulator.size(), 3u);
+    EXPECT_EQ(newestAccumulator.take(), std::vector<std::string>({"1.999-1", "1.998-1", "1.997-1"}));
+    EXPECT_EQ(newestAccumulator.size(), 0u);
+    EXPECT_EQ(oldestAccumulator.take(), std::vector<std::string>({"1.0-1", "1.1-1"}));
+}
+
+/* ================================== MEMORY RESOURCES ================================= */
+
+using rpmcmp_tests::CountingResource;
+
+TEST(RpmCmp, RpmEvrAllocatesFromResource) {
+    // Arrange
+    CountingResource resource;
+    std::string_view evr = "1:2.0.0.20240101.snapshot-1.fc40.x86_64.release";
+
+    // Act
+    rpmcmplib::RpmEvr rpmEvr(evr, &resource);
+    rpmcmplib::RpmVer rpmVer(std::string("2.0.0.20240101.snapshot"), &resource);
+
+    // Assert
+    EXPECT_EQ(resource.allocations, 3u);
+    EXPECT_EQ(rpmEvr.get_allocator().resource(), &resource);
+    EXPECT_EQ(rpmEvr.epoch(), 1u);
+    EXPECT_EQ(rpmEvr.version(), "2.0.0.20240101.snapshot");
+    EXPECT_EQ(rpmEvr.release(), "1.fc40.x86_64.release");
+    EXPECT_TRUE(rpmEvr == rpmcmplib::RpmEvr("1:2.0.0.20240101.snapshot-1.fc40.x86_64.release"));
+    EXPECT_TRUE(rpmVer == rpmcmplib::RpmVer("2.0.0.20240101.snapshot"));
+}
+
+TEST(RpmCmp, RpmEvrWithResourceInvalidEvr) {
+    // Arrange
+    CountingResource resource;
+    std::string result;
+
+    // Act
+    try {
+        rpmcmplib::RpmEvr evr("1:1.0-1-1", &resource);
+    } catch(const std::exception& e) {
+        result = e.what();
+    }
+
+    // Assert
+    EXPECT_EQ(result, std::string("EVR must contain only one hyphen symbol!"));
+}
+
+TEST(RpmCmp, PmrVectorPassesResourceToEvrs) {
+    // Arrange
+    std::vector<std::byte> buffer(64 * 1024);
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    std::pmr::vector<rpmcmplib::RpmEvr> evrs(&arena);
+
+    // Act
+    for (int i = 0; i < 100; ++i) {
+        evrs.emplace_back("1:" + std::to_string(i) + ".0.0.20240101.snapshot-1.fc40.x86_64.release");
+    }
+    std::vector<rpmcmplib::RpmEvr> copies(evrs.begin(), evrs.end());
+
+    // Assert
+    for (const auto& evr : evrs) {
+        EXPECT_EQ(evr.get_allocator().resource(), &arena);
+    }
+    EXPECT_EQ(copies.front().get_allocator().resource(), std::pmr::get_default_resource());
+    EXPECT_EQ(rpmcmplib::newest(evrs, 1).at(0).version(), "99.0.0.20240101.snapshot");
+}
+
+TEST(RpmCmp, RpmVerSegmentsFromResource) {
+    // Arrange
+    CountingResource resource;
+    std::string_view label = "1.002.3.abc.001ab";
+    std::vector<std::string_view> expectedSegments = {"1", "002", "3", "abc", "001", "ab"};
+
+    // Act
+    auto segments = rpmcmplib::RpmVer::segments(label, &resource);
+
+    // Assert
+    EXPECT_GT(resource.allocations, 0u);
+    EXPECT_TRUE(std::equal(segments.begin(), segments.end(), expectedSegments.begin(), expectedSegments.end()));
+}
@@ -0,0 +1,335 @@
+// SPDX-License-Identifier: MIT
+
+#include <client.hpp>
+#include <server.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using rpmcmplib::rpmcmpd::Client;
+using rpmcmplib::rpmcmpd::Constraint;
+using rpmcmplib::rpmcmpd::EvrTable;
+using rpmcmplib::rpmcmpd::Opcode;
+using rpmcmplib::rpmcmpd::RequestFailed;
+using rpmcmplib::rpmcmpd::Server;
+using rpmcmplib::rpmcmpd::ServerOptions;
+using rpmcmplib::rpmcmpd::Status;
+using rpmcmplib::rpmcmpd::Writer;
+
+namespace {
+
+const char* tableContent =
+    "# name evr\n"
+    "bash 5.1.8-2\n"
+    "bash 5.2.15-1\n"
+    "bash 5.1.8-10\n"
+    "\n"
+    "kernel 6.1.0-1\n"
+    "kernel 1:5.10.0-1\n"
+    "kernel 6.2.0~rc1-1\n";
+
+std::string writeFile(const std::string& name, const std::string& content) {
+    std::string path = "/tmp/rpmcmpd_tests_" + std::to_string(::getpid()) + "_" + name;
+    std::ofstream(path) << content;
+    return path;
+}
+
+int connectTo(const std::string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+class RpmcmpdServer : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_tablePath = writeFile("table", tableContent);
+        m_socketPath = "/tmp/rpmcmpd_tests_" + std::to_string(::getpid()) + ".sock";
+
+        ServerOptions options;
+        options.socketPath = m_socketPath;
+        options.tablePath = m_tablePath;
+        options.workers = 4;
+        options.maxBatch = 8;
+        m_server = std::make_unique<Server>(options);
+        m_server->start();
+    }
+
+    void TearDown() override {
+        m_server->stop();
+        std::remove(m_tablePath.c_str());
+    }
+
+    std::string m_tablePath;
+    std::string m_socketPath;
+    std::unique_ptr<Server> m_server;
+};
+
+} // namespace
+
+TEST(RpmcmpdTable, ParseSortsVersionsPerName) {
+    // Arrange
+    auto table = EvrTable::parse(tableContent);
+
+    // Act
+    const auto& versions = table->versions("bash");
+
+    // Assert
+    EXPECT_EQ(table->size(), 6u);
+    ASSERT_EQ(versions.size(), 3u);
+    EXPECT_EQ(versions[0].evr(), "5.1.8-2");
+    EXPECT_EQ(versions[1].evr(), "5.1.8-10");
+    EXPECT_EQ(versions[2].evr(), "5.2.15-1");
+    ASSERT_EQ(table->parts("bash").size(), 3u);
+    EXPECT_EQ(table->parts("bash")[1].release, "10");
+    EXPECT_EQ(table->newest("kernel")->evr(), "1:5.10.0-1");
+    EXPECT_EQ(table->newest("zsh"), nullptr);
+    EXPECT_TRUE(table->versions("zsh").empty());
+}
+
+TEST(RpmcmpdTable, ParseInvalidLine) {
+    // Arrange
+    std::string result;
+
+    // Act
+    try {
+        EvrTable::parse("bash 5.1.8-2\nbash 5.1-8-2\n");
+    } catch(const std::exception& e) {
+        result = e.what();
+    }
+
+    // Assert
+    EXPECT_EQ(result, std::string("Line 2: EVR must contain only one hyphen symbol!"));
+}
+
+TEST_F(RpmcmpdServer, Compare) {
+    Client client(m_socketPath);
+
+    EXPECT_EQ(client.compare("1:1.2.3-1", "0:1.2.3-1"), 1);
+    EXPECT_EQ(client.compare("3.0.0_fc", "3.0.0.fc"), 0);
+    EXPECT_EQ(client.compare("1.1~201601", "1.1"), -1);
+}
+
+TEST_F(RpmcmpdServer, CompareInvalidEvr) {
+    // Arrange
+    Client client(m_socketPath);
+    Status status = Status::Ok;
+    std::string result;
+
+    // Act
+    try {
+        client.compare("1.2.3-a-", "1.2.3-a");
+    } catch(const RequestFailed& e) {
+        status = e.status();
+        result = e.what();
+    }
+
+    // Assert
+    EXPECT_EQ(status, Status::InvalidEvr);
+    EXPECT_EQ(result, std::string("EVR must contain only one hyphen symbol!"));
+    EXPECT_EQ(client.compare("1.0", "1.1"), -1) << "connection is still usable after failed request";
+}
+
+TEST_F(RpmcmpdServer, Sort) {
+    Client client(m_socketPath);
+
+    std::vector<uint32_t> expectedOrder = {3, 1, 0, 2};
+    EXPECT_EQ(client.sort({"1.10", "1.2", "1:0.1", "1.0~rc1"}), expectedOrder);
+}
+
+TEST_F(RpmcmpdServer, Newest) {
+    // Arrange
+    Client client(m_socketPath);
+    Status status = Status::Ok;
+
+    // Act
+    try {
+        client.newest("zsh");
+    } catch(const RequestFailed& e) {
+        status = e.status();
+    }
+
+    // Assert
+    EXPECT_EQ(client.newest("bash"), "5.2.15-1");
+    EXPECT_EQ(client.newest("kernel"), "1:5.10.0-1");
+    EXPECT_EQ(status, Status::NotFound);
+}
+
+TEST_F(RpmcmpdServer, Match) {
+    Client client(m_socketPath);
+
+    EXPECT_EQ(client.match("bash", Constraint::Less, "5.1.8-10"), std::vector<std::string>({"5.1.8-2"}));
+    EXPECT_EQ(client.match("bash", Constraint::LessOrEqual, "5.1.8-10"), std::vector<std::string>({"5.1.8-2", "5.1.8-10"}));
+    EXPECT_EQ(client.match("bash", Constraint::Equal, "0:5.1.08-10"), std::vector<std::string>({"5.1.8-10"}));
+    EXPECT_EQ(client.match("bash", Constraint::GreaterOrEqual, "5.1.8-10"), std::vector<std::string>({"5.1.8-10", "5.2.15-1"}));
+    EXPECT_EQ(client.match("bash", Constraint::Greater, "5.2.15-1"), std::vector<std::string>());
+    EXPECT_EQ(client.match("kernel", Constraint::Less, "6.1.0-1"), std::vector<std::string>({"6.2.0~rc1-1"}));
+    EXPECT_EQ(client.match("kernel", Constraint::Greater, "0:6.2.0~rc1-1"),
+              std::vector<std::string>({"6.1.0-1", "1:5.10.0-1"}));
+    EXPECT_EQ(client.match("kernel", Constraint::LessOrEqual, "1:1.0-1"), std::vector<std::string>({"6.2.0~rc1-1", "6.1.0-1"}));
+}
+
+TEST_F(RpmcmpdServer, ReloadKeepsConnections) {
+    // Arrange
+    Client client(m_socketPath);
+    EXPECT_EQ(client.newest("bash"), "5.2.15-1");
+    writeFile("table", "bash 5.2.21-1\nzsh 5.9-1\n");
+
+    // Act
+    size_t loaded = client.reload();
+
+    // Assert
+    EXPECT_EQ(loaded, 2u);
+    EXPECT_EQ(client.newest("bash"), "5.2.21-1");
+    EXPECT_EQ(client.newest("zsh"), "5.9-1");
+}
+
+TEST_F(RpmcmpdServer, FailedReloadKeepsTable) {
+    // Arrange
+    Client client(m_socketPath);
+    writeFile("table", "bash\n");
+    Status status = Status::Ok;
+
+    // Act
+    try {
+        client.reload();
+    } catch(const RequestFailed& e) {
+        status = e.status();
+    }
+
+    // Assert
+    EXPECT_EQ(status, Status::ReloadFailed);
+    EXPECT_EQ(client.newest("bash"), "5.2.15-1");
+}
+
+TEST_F(RpmcmpdServer, ReloadFromPathIsForbiddenByDefault) {
+    // Arrange
+    Client client(m_socketPath);
+    std::string newTablePath = writeFile("new_table", "bash 5.2.21-1\n");
+    Status status = Status::Ok;
+
+    // Act
+    try {
+        client.reload(newTablePath);
+    } catch(const RequestFailed& e) {
+        status = e.status();
+    }
+
+    // Assert
+    EXPECT_EQ(status, Status::Forbidden);
+    EXPECT_EQ(client.newest("bash"), "5.2.15-1");
+    std::remove(newTablePath.c_str());
+}
+
+TEST_F(RpmcmpdServer, ReloadFromAllowedPath) {
+    // Arrange
+    m_server->stop();
+    ServerOptions options;
+    options.socketPath = m_socketPath;
+    options.tablePath = m_tablePath;
+    options.allowReloadPath = true;
+    m_server = std::make_unique<Server>(options);
+    m_server->start();
+    Client client(m_socketPath);
+    std::string newTablePath = writeFile("new_table", "bash 5.2.21-1\nzsh 5.9-1\n");
+
+    // Act
+    size_t loaded = client.reload(newTablePath);
+
+    // Assert
+    EXPECT_EQ(loaded, 2u);
+    EXPECT_EQ(client.newest("zsh"), "5.9-1");
+    std::remove(newTablePath.c_str());
+}
+
+TEST_F(RpmcmpdServer, ConcurrentClients) {
+    // Arrange
+    std::vector<std::thread> threads;
+    std::vector<int> failures(8, 0);
+
+    // Act
+    for (size_t i = 0; i < failures.size(); ++i) {
+        threads.emplace_back([this, &failures, i] {
+            Client client(m_socketPath);
+            for (int j = 0; j < 200; ++j) {
+                failures[i] += client.compare("1.0-" + std::to_string(j), "1.0-" + std::to_string(j + 1)) != -1;
+                failures[i] += client.newest("bash") != "5.2.15-1";
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Assert
+    for (int failure : failures) {
+        EXPECT_EQ(failure, 0);
+    }
+}
+
+TEST_F(RpmcmpdServer, ClientThatDoesNotReadDoesNotBlockOthers) {
+    // Arrange
+    int flooder = connectTo(m_socketPath);
+    ASSERT_GE(flooder, 0);
+    Writer request;
+    request.u32(1).u8(static_cast<uint8_t>(Opcode::Sort)).u32(1000);
+    for (int i = 0; i < 1000; ++i) {
+        request.str("1.0-" + std::to_string(i));
+    }
+    auto frame = request.finish();
+
+    // pipeline requests and never read responses, until server stops reading too
+    size_t sent = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (sent < 1000 * frame.size() && std::chrono::steady_clock::now() < deadline) {
+        ssize_t result = ::send(flooder, frame.data() + sent % frame.size(), frame.size() - sent % frame.size(),
+                                MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (result > 0) {
+            sent += static_cast<size_t>(result);
+        }
+    }
+
+    // Act
+    auto result = std::async(std::launch::async, [this] {
+        Client client(m_socketPath);
+        return client.compare("1.0", "1.1");
+    });
+
+    // Assert
+    // other client waits only for already queued requests, blocked server would never answer
+    ASSERT_EQ(result.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+    EXPECT_EQ(result.get(), -1);
+
+    // responses that were held back are delivered once client reads them
+    timeval timeout{5, 0};
+    ::setsockopt(flooder, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    size_t expectedSize = (sent / frame.size()) * (4 + 4 + 1 + 4 + 1000 * 4);
+    size_t received = 0;
+    std::vector<uint8_t> chunk(64 * 1024);
+    while (received < expectedSize) {
+        ssize_t count = ::recv(flooder, chunk.data(), chunk.size(), 0);
+        if (count <= 0) {
+            break;
+        }
+        received += static_cast<size_t>(count);
+    }
+    EXPECT_EQ(received, expectedSize);
+    ::close(flooder);
+}